@@ -202,24 +202,23 @@ PBase::Values PApxData::unpack(const xbus::pid_s &pid,
         qWarning() << "pri:" << pid.pri << Mandala::meta(pid.uid).path;
     }
 
-    QVariant v;
+    bool ok = false;
     switch (spec.type) {
     case mandala::type_byte:
-        v = unpack<mandala::byte_t>(stream);
+        ok = unpack<mandala::byte_t>(pid.uid, stream, &values);
         break;
     case mandala::type_word:
-        v = unpack<mandala::word_t>(stream);
+        ok = unpack<mandala::word_t>(pid.uid, stream, &values);
         break;
     case mandala::type_dword:
-        v = unpack<mandala::dword_t>(stream);
+        ok = unpack<mandala::dword_t>(pid.uid, stream, &values);
         break;
     case mandala::type_real:
-        v = unpack<mandala::real_t>(stream);
+        ok = unpack<mandala::real_t>(pid.uid, stream, &values);
         break;
     }
-    values.insert(pid.uid, v);
 
-    if (v.isNull()) {
+    if (!ok) {
         values.clear();
         // error
         qDebug() << "error: " << Mandala::meta(pid.uid).path << stream.available()
@@ -54,11 +54,12 @@ private:
     static void pack(const QVariant &v, mandala::type_id_e type, PStreamWriter &stream);
 
     template<typename T>
-    static QVariant unpack(PStreamReader &stream)
+    static bool unpack(mandala::uid_t uid, PStreamReader &stream, PBase::Values *values)
     {
         if (stream.available() < sizeof(T))
-            return QVariant();
-        return QVariant::fromValue(stream.read<T>());
+            return false;
+        values->insert(uid, stream.read<T>());
+        return true;
     }
     static PBase::Values unpack(const xbus::pid_s &pid,
                                 const mandala::spec_s &spec,
@@ -30,6 +30,8 @@
 
 #include <crc.h>
 
+#include <Database/Database.h>
+#include <Database/NodeDictCache.h>
 #include <Database/VehiclesReqNode.h>
 
 PApxNode::PApxNode(PApxNodes *parent, QString uid)
@@ -340,6 +342,18 @@ void PApxNode::requestDict()
         return;
     }
 
+    // preloaded dictionaries cache
+    bool ok = false;
+    xbus::node::hash_t hash = _dict_hash.toUInt(&ok, 16);
+    if (ok) {
+        auto dict = Database::instance()->vehicles->dictCache->dict(hash);
+        if (!dict.isEmpty()) {
+            QMetaObject::invokeMethod(
+                this, [this, dict]() { dictCacheLoaded(dict); }, Qt::QueuedConnection);
+            return;
+        }
+    }
+
     auto *req = new DBReqLoadNodeDict(uid(), _dict_hash);
     connect(req,
             &DBReqLoadNodeDict::dictLoaded,
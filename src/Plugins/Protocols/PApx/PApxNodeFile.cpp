@@ -162,22 +162,41 @@ bool PApxNodeFile::read(PStreamReader &stream)
 
     xbus::node::file::offset_t offset;
     stream >> offset;
-    if (offset != _offset) { //just skip non-sequental
+    if (offset < _offset) { //just skip duplicates
         return true;
     }
+    if (offset > _offset) { // windowed transfer
+        _parts.insert(offset, stream.payload());
+        return true;
+    }
+
+    //qDebug() << "rd:" << offset << stream.available();
+
+    if (!append(stream.payload()))
+        return false;
 
-    size_t size = stream.available();
+    while (!_parts.isEmpty() && _parts.firstKey() <= _offset) {
+        offset = _parts.firstKey();
+        QByteArray data = _parts.take(offset);
+        if (offset < _offset)
+            continue;
+        if (!append(data))
+            return false;
+    }
+    return true;
+}
+bool PApxNodeFile::append(const QByteArray &data)
+{
+    size_t size = static_cast<size_t>(data.size());
     _offset += size;
     _tcnt += size;
 
-    //qDebug() << "rd:" << offset << size;
-
     if (_tcnt > _size)
         return false;
 
-    _hash = apx::crc32(stream.ptr(), size, _hash);
+    _hash = apx::crc32(data.constData(), size, _hash);
 
-    _data.append(stream.payload());
+    _data.append(data);
     return true;
 }
 
@@ -187,6 +206,7 @@ void PApxNodeFile::reset()
     _hash = 0xFFFFFFFF;
 
     _data.clear();
+    _parts.clear();
 
     _open_op = xbus::node::file::idle;
 
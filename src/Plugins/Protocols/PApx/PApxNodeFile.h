@@ -56,7 +56,10 @@ private:
 
     xbus::node::file::op_e _open_op{};
 
+    QMap<xbus::node::file::offset_t, QByteArray> _parts; // received ahead of offset
+
     bool read(PStreamReader &stream);
+    bool append(const QByteArray &data);
     bool check_info(PStreamReader &stream);
 
     void updateProgress();
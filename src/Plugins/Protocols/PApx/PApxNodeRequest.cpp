@@ -349,9 +349,28 @@ bool PApxNodeRequestFile::request(PApxRequest &req)
     if (_op != _op_file)
         return false;
 
-    req.write<xbus::node::file::offset_t>(_offset);
+    xbus::node::file::offset_t offset;
+    if (!select(&offset, true))
+        return false;
+
+    auto it = _chunks.find(offset);
+    if (it == _chunks.end()) {
+        // new chunk at the end of requested data
+        size_t size = _start + _info.size - offset;
+        if (_chunk && size > _chunk)
+            size = _chunk;
+        it = _chunks.insert(offset, {size, 0, 0, 0});
+        _next = offset + size;
+    } else if (it->cnt == 1) {
+        // lost chunk
+        _window = qMax<qreal>(1., _window / 2.);
+    }
+    it->time = _time.elapsed();
+    it->cnt++;
+
+    req.write<xbus::node::file::offset_t>(offset);
 
-    return request_file(req);
+    return request_file(req, offset, it->size);
 }
 void PApxNodeRequestFile::reset()
 {
@@ -360,6 +379,87 @@ void PApxNodeRequestFile::reset()
     _offset = 0;
     _tcnt = 0;
     _hash = 0xFFFFFFFF;
+
+    _chunks.clear();
+    _start = _next = 0;
+    _chunk = 0;
+}
+
+bool PApxNodeRequestFile::pending() const
+{
+    xbus::node::file::offset_t offset;
+    return _op == _op_file && select(&offset, false);
+}
+qint64 PApxNodeRequestFile::retransmit() const
+{
+    if (!windowed())
+        return -1;
+    qint64 t = _time.elapsed();
+    qint64 rto = this->rto();
+    qint64 v = -1;
+    for (auto const &c : _chunks) {
+        qint64 dt = c.cnt ? qMax<qint64>(0, c.time + rto - t) : 0;
+        if (v < 0 || dt < v)
+            v = dt;
+    }
+    return v;
+}
+qint64 PApxNodeRequestFile::rto() const
+{
+    if (_rtt < 0)
+        return _timeout_ms;
+    return qBound<qint64>(50, static_cast<qint64>(_rtt * 2.) + 20, _timeout_ms);
+}
+bool PApxNodeRequestFile::select(xbus::node::file::offset_t *offset, bool force) const
+{
+    qint64 t = _time.elapsed();
+    qint64 rto = this->rto();
+    int cnt = 0;
+    for (auto it = _chunks.begin(); it != _chunks.end(); ++it) {
+        // holes and lost chunks go first, by offset
+        if (!it->cnt || t - it->time >= rto) {
+            *offset = it.key();
+            return true;
+        }
+        cnt++;
+    }
+    // new chunks while the window allows, one until chunk size is known
+    if (cnt < static_cast<int>(_window) && (_chunk || !cnt) && _next < _start + _info.size) {
+        *offset = _next;
+        return true;
+    }
+    if (!force || _chunks.isEmpty())
+        return false;
+    *offset = _chunks.firstKey();
+    return true;
+}
+void PApxNodeRequestFile::ack(xbus::node::file::offset_t offset, size_t size)
+{
+    chunk_s c = _chunks.take(offset);
+    if (c.cnt == 1) {
+        // round trip of retransmitted chunks is ambiguous
+        qreal rtt = _time.elapsed() - c.time;
+        _rtt = _rtt < 0 ? rtt : _rtt * 0.875 + rtt * 0.125;
+        if (_rtt_min < 0 || rtt < _rtt_min)
+            _rtt_min = rtt;
+
+        // grow while round trip stays near its minimum, shrink when the link queues
+        if (_rtt < _rtt_min * 1.5 + 10)
+            _window += 1. / _window;
+        else if (_rtt > _rtt_min * 2. + 20)
+            _window -= 1. / _window;
+        _window = qBound<qreal>(1., _window, window_max);
+    }
+    if (!_chunk)
+        _chunk = size;
+
+    if (size >= c.size)
+        return;
+    // partial response
+    if (offset + c.size == _next)
+        _next = offset + size;
+    else
+        _chunks.insert(offset + size, {c.size - size, 0, 0, 0});
 }
 bool PApxNodeRequestFile::response(PStreamReader &stream)
 {
@@ -394,9 +494,8 @@ bool PApxNodeRequestFile::response(PStreamReader &stream)
             return false;
         xbus::node::file::offset_t offset;
         stream >> offset;
-        if (offset != _offset) {
-            qWarning() << "ext offset: " << QString::number(offset, 16)
-                       << QString::number(_offset, 16);
+        if (!_chunks.contains(offset)) {
+            qWarning() << "ext offset: " << QString::number(offset, 16);
             // response offset mismatch - don't interrupt
             return false;
         }
@@ -425,6 +524,7 @@ bool PApxNodeRequestFile::response(PStreamReader &stream)
         _info.read(&stream);
         _offset = _info.offset;
         opened();
+        _start = _next = _offset;
         next();
         return false;
     }
@@ -454,8 +554,7 @@ bool PApxNodeRequestFile::response(PStreamReader &stream)
 
     xbus::node::file::offset_t offset;
     stream >> offset;
-    if (offset != _offset) { //just skip non-sequental
-        qWarning() << "offset:" << QString::number(offset, 16) << QString::number(_offset, 16);
+    if (!_chunks.contains(offset)) { //just skip duplicates and not requested
         return false;
     }
 
@@ -467,24 +566,41 @@ void PApxNodeRequestFile::next()
         //all data read
         //qDebug() << "done";
         _op = xbus::node::file::close;
+        _chunks.clear();
         _node->reschedule_request(this);
         return;
     }
+    // more chunks or wait for responses in flight
     _op = _op_file;
     _node->reschedule_request(this);
 }
 
 bool PApxNodeRequestFileRead::response_file(xbus::node::file::offset_t offset, PStreamReader &stream)
 {
-    size_t size = stream.available();
-    _offset += size;
-    _tcnt += size;
-
-    if (_tcnt > _info.size) {
-        qWarning() << "overflow:" << _tcnt << _info.size;
-        return true;
+    QByteArray data = stream.payload();
+    size_t size = static_cast<size_t>(data.size());
+    if (size > _chunks.value(offset).size) {
+        // keep the requested part only, the rest is requested again if needed
+        qWarning() << "overflow:" << size << _chunks.value(offset).size;
+        size = _chunks.value(offset).size;
+        data.truncate(static_cast<int>(size));
+    }
+    ack(offset, size);
+    _parts.insert(offset, data);
+
+    // consume sequential data
+    while (!_parts.isEmpty() && _parts.firstKey() == _offset) {
+        data = _parts.take(_offset);
+        size = static_cast<size_t>(data.size());
+        _offset += size;
+        _tcnt += size;
+
+        if (_tcnt > _info.size) {
+            qWarning() << "overflow:" << _tcnt << _info.size;
+            return true;
+        }
+        _hash = apx::crc32(data.constData(), size, _hash);
     }
-    _hash = apx::crc32(stream.ptr(), size, _hash);
 
     size_t v = _info.size > 0 ? _tcnt * 100 / _info.size : 0;
     _node->setProgress(static_cast<int>(v));
@@ -498,22 +614,20 @@ void PApxNodeRequestFileWrite::opened()
 {
     _info.size = _data.size();
     _offset = _woffset;
+    _chunk = 256;
 }
-bool PApxNodeRequestFileWrite::request_file(PApxRequest &req)
+bool PApxNodeRequestFileWrite::request_file(PApxRequest &req,
+                                            xbus::node::file::offset_t offset,
+                                            size_t size)
 {
     // write data part
-    size_t tail = _info.size - _tcnt;
-    size_t sz = 256;
-    if (sz > tail)
-        sz = tail;
-
-    const QByteArray &ba = _data.mid(static_cast<int>(_tcnt), static_cast<int>(sz));
-    if (static_cast<int>(sz) != ba.size()) {
-        qWarning() << "block size: " << sz << ba.size();
+    const QByteArray &ba = _data.mid(static_cast<int>(offset - _start), static_cast<int>(size));
+    if (static_cast<int>(size) != ba.size()) {
+        qWarning() << "block size: " << size << ba.size();
         return false;
     }
-    sz = req.write(ba.data(), sz);
-    _hash = apx::crc32(ba.data(), sz);
+    size = req.write(ba.data(), size);
+    _chunks[offset].hash = apx::crc32(ba.data(), size);
     return true;
 }
 bool PApxNodeRequestFileWrite::response_file(xbus::node::file::offset_t offset,
@@ -535,15 +649,16 @@ bool PApxNodeRequestFileWrite::response_file(xbus::node::file::offset_t offset,
     xbus::node::hash_t hash;
     stream >> hash;
 
-    if (hash != _hash) {
-        qWarning() << "hash: " << QString::number(hash, 16) << QString::number(_hash, 16);
+    const chunk_s &c = _chunks[offset];
+    if (hash != c.hash) {
+        qWarning() << "hash: " << QString::number(hash, 16) << QString::number(c.hash, 16);
         return false;
     }
 
-    if (stream.available() > 0)
+    if (stream.available() > 0 || size > c.size)
         return false;
 
-    _offset += size;
+    ack(offset, size);
     _tcnt += size;
     if (_tcnt > _info.size)
         return false;
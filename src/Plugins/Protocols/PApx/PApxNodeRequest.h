@@ -51,6 +51,11 @@ public:
 
     virtual QString cid() const { return QString(); } // compare ID to check duplicates
 
+    // windowed requests keep several packets in flight
+    virtual bool windowed() const { return false; }
+    virtual bool pending() const { return false; } // more packets ready to send
+    virtual qint64 retransmit() const { return -1; } // time to the earliest resend [ms]
+
     static constexpr uint retries = 5;
 
     bool silent{};
@@ -161,7 +166,15 @@ public:
         , _op_init(op_init)
         , _op_file(op_file)
         , _op(op_init)
-    {}
+    {
+        _time.start();
+    }
+
+    bool windowed() const override { return _op == _op_file && _op != _op_init; }
+    bool pending() const override;
+    qint64 retransmit() const override;
+
+    static constexpr int window_max = 16; // chunks in flight
 
 protected:
     QString _name;
@@ -174,6 +187,27 @@ protected:
     xbus::node::file::size_t _tcnt{};
     xbus::node::hash_t _hash{};
 
+    // windowed transfer state
+    struct chunk_s
+    {
+        size_t size;
+        qint64 time; // last sent [ms]
+        uint cnt;    // transmissions
+        xbus::node::hash_t hash;
+    };
+    QMap<xbus::node::file::offset_t, chunk_s> _chunks; // requested and not acknowledged
+    xbus::node::file::offset_t _start{};
+    xbus::node::file::offset_t _next{}; // next offset to request
+    size_t _chunk{};                    // chunk size, zero when unknown
+    qreal _window{1};
+    qreal _rtt{-1}; // smoothed round trip [ms]
+    qreal _rtt_min{-1};
+    QElapsedTimer _time;
+
+    qint64 rto() const;
+    bool select(xbus::node::file::offset_t *offset, bool force) const;
+    void ack(xbus::node::file::offset_t offset, size_t size);
+
     void reset();
     void next();
 
@@ -187,7 +221,10 @@ protected:
     {
         return true;
     }
-    virtual bool request_file(PApxRequest &req) { return true; }
+    virtual bool request_file(PApxRequest &req, xbus::node::file::offset_t offset, size_t size)
+    {
+        return true;
+    }
 
 signals:
     void downladed();
@@ -207,6 +244,9 @@ public:
     }
 
 private:
+    QMap<xbus::node::file::offset_t, QByteArray> _parts; // received ahead of offset
+
+    void opened() override { _parts.clear(); }
     bool response_file(xbus::node::file::offset_t offset, PStreamReader &stream) override;
 };
 
@@ -230,6 +270,6 @@ private:
     size_t _woffset;
 
     void opened() override;
-    bool request_file(PApxRequest &req) override;
+    bool request_file(PApxRequest &req, xbus::node::file::offset_t offset, size_t size) override;
     bool response_file(xbus::node::file::offset_t offset, PStreamReader &stream) override;
 };
@@ -30,16 +30,38 @@
 
 #define PAPX_REQ_DELAY_MS 0
 
+// link bandwidth budget shared by all vehicles
+static struct
+{
+    QElapsedTimer time;
+    qreal tokens{};
+
+    // returns time to wait for the next token [ms]
+    qint64 take()
+    {
+        if (!time.isValid()) {
+            time.start();
+            tokens = PApxNodes::req_burst;
+        }
+        tokens += time.restart() * PApxNodes::req_rate / 1000.;
+        if (tokens > PApxNodes::req_burst)
+            tokens = PApxNodes::req_burst;
+        if (tokens >= 1.) {
+            tokens -= 1.;
+            return 0;
+        }
+        return qCeil((1. - tokens) * 1000. / PApxNodes::req_rate);
+    }
+} _budget;
+
 PApxNodes::PApxNodes(PApxVehicle *parent)
     : PNodes(parent)
     , _req(parent)
     , _local(parent->uid().isEmpty())
 {
-    _reqTimeout.setSingleShot(true);
-    connect(&_reqTimeout, &QTimer::timeout, this, &PApxNodes::request_timeout);
-
-    _reqNext.setSingleShot(true);
-    connect(&_reqNext, &QTimer::timeout, this, &PApxNodes::request_current);
+    _time.start();
+    _reqTimer.setSingleShot(true);
+    connect(&_reqTimer, &QTimer::timeout, this, &PApxNodes::request_process);
 
     connect(root(), &PBase::cancelRequests, this, [this]() { cancel_requests(nullptr); });
 
@@ -52,12 +74,12 @@ void PApxNodes::updateActive()
 {
     bool v = parent()->active() || (upgrading() && _local);
 
-    _reqNext.setInterval(v ? PAPX_REQ_DELAY_MS : 1000);
+    // inactive vehicle downloads one node at a time
+    _reqDelay = v ? PAPX_REQ_DELAY_MS : 1000;
+    _window = v ? window : 1;
 
-    if (_reqNext.isActive()) {
-        _reqNext.stop();
-        _reqNext.start();
-    }
+    if (!_requests.isEmpty())
+        schedule(_time.elapsed());
 }
 
 bool PApxNodes::process_downlink(const xbus::pid_s &pid, PStreamReader &stream)
@@ -139,110 +161,182 @@ void PApxNodes::request_scheduled(PApxNodeRequest *req)
     // qDebug() << req->title();
     if (_requests.contains(req)) {
         // rescheduled request
-        if (_request != req) // not current
+        auto it = _slots.find(req->node());
+        if (it == _slots.end() || it->req != req) // not in flight
             return;
-        _retry = PApxNodeRequest::retries;
-        _reqTimeout.stop();
-        _reqNext.start();
+        it->retry = PApxNodeRequest::retries;
+        it->sent = false;
+        it->time = _time.elapsed() + _reqDelay;
+        it->deadline = 0;
+        schedule(it->time);
         return;
     }
     _requests.append(req);
-    if (_request)
-        return;
-    request_next();
+    schedule(_time.elapsed());
 }
 void PApxNodes::request_finished(PApxNodeRequest *req)
 {
     // qDebug() << req->title();
     _requests.removeOne(req);
-    if (_request && _request != req)
-        return;
-    _request = nullptr;
+    auto it = _slots.find(req->node());
+    if (it != _slots.end() && it->req == req)
+        _slots.erase(it);
 
-    _reqTimeout.stop();
     if (_requests.isEmpty()) {
         return;
     }
-    request_next();
+    schedule(_time.elapsed());
 }
 void PApxNodes::request_extended(PApxNodeRequest *req, size_t time_ms)
 {
-    if (_request != req)
+    auto it = _slots.find(req->node());
+    if (it == _slots.end() || it->req != req || !it->sent)
         return;
-    _reqTimeout.stop();
-    _reqTimeout.start(time_ms);
+    it->time = _time.elapsed() + static_cast<qint64>(time_ms);
+    if (it->deadline)
+        it->deadline = it->time;
+    schedule(it->time);
 }
 
-void PApxNodes::request_next()
+void PApxNodes::schedule(qint64 time)
 {
-    if (_request) {
-        qDebug() << "pending";
+    qint64 dt = qMax<qint64>(0, time - _time.elapsed());
+    if (_reqTimer.isActive() && _reqTimer.remainingTime() <= dt)
         return;
+    _reqTimer.start(static_cast<int>(dt));
+}
+
+void PApxNodes::request_process()
+{
+    qint64 t = _time.elapsed();
+
+    // expired requests, may cancel all node requests
+    for (auto node : _slots.keys()) {
+        auto it = _slots.find(node);
+        if (it == _slots.end() || !it->sent || it->time > t)
+            continue;
+        if (it->deadline > t) {
+            // lost chunks of windowed request, resend without retry
+            it->sent = false;
+            continue;
+        }
+        timeout_request(node, t);
     }
 
-    if (_requests.isEmpty()) {
-        qDebug() << "empty";
-        return;
+    fill_slots(t);
+
+    // due requests within link budget
+    qint64 next = -1;
+    for (auto node : _slots.keys()) {
+        auto it = _slots.find(node);
+        if (it == _slots.end())
+            continue;
+        if (!it->sent && it->time <= t) {
+            qint64 wait = _budget.take();
+            if (wait) {
+                it->time = t + wait;
+            } else {
+                send_request(node, t);
+                it = _slots.find(node);
+                if (it == _slots.end())
+                    continue;
+            }
+        }
+        if (next < 0 || it->time < next)
+            next = it->time;
     }
+    if (next >= 0)
+        schedule(next);
+}
 
-    _request = _requests.first();
-    _retry = PApxNodeRequest::retries;
-    _reqNext.start();
+void PApxNodes::fill_slots(qint64 t)
+{
+    // the oldest request of each idle node
+    for (auto req : _requests) {
+        if (_slots.size() >= _window)
+            break;
+        if (_slots.contains(req->node()))
+            continue;
+        _slots.insert(req->node(), {req, PApxNodeRequest::retries, false, t + _reqDelay, 0});
+    }
 }
 
-void PApxNodes::request_current()
+void PApxNodes::send_request(PApxNode *node, qint64 t)
 {
-    if (!_request)
+    PApxNodeRequest *req = _slots.value(node).req;
+    // qDebug() << req->title();
+
+    // windowed requests may only wait for responses in flight
+    if (!req->windowed() || req->pending()) {
+        do {
+            if (!req->make_request(_req)) {
+                // qDebug() << "discarded";
+                req->discard();
+                return;
+            }
+            _req.send();
+        } while (req->pending() && !_budget.take());
+    }
+
+    auto it = _slots.find(node);
+    if (it == _slots.end())
         return;
-    // qDebug() << _request->title();
-    if (!_request->make_request(_req)) {
-        // qDebug() << "discarded";
-        _request->discard();
+    it->sent = true;
+    it->time = t + (req->timeout_ms() ? req->timeout_ms() : 100);
+    if (!req->windowed())
         return;
-    }
-    _req.send();
-    _reqTimeout.stop();
-    _reqTimeout.start(_request->timeout_ms() ? _request->timeout_ms() : 100);
+
+    // wake up on the earliest chunk resend, timeout counts from the first send
+    if (!it->deadline)
+        it->deadline = it->time;
+    it->time = it->deadline;
+    qint64 dt = req->retransmit();
+    if (dt >= 0 && t + dt < it->time)
+        it->time = t + dt;
 }
 
-void PApxNodes::request_timeout()
+void PApxNodes::timeout_request(PApxNode *node, qint64 t)
 {
-    if (!_request)
-        return;
+    auto it = _slots.find(node);
+    PApxNodeRequest *req = it->req;
 
-    if (!_request->timeout_ms()) {
-        _request->discard();
+    if (!req->timeout_ms()) {
+        req->discard();
         return;
     }
 
-    if (!_retry) {
-        if (!_request->silent) {
-            apxMsgW() << tr("NMT request dropped").append(':') << _request->title();
+    if (!it->retry) {
+        if (!req->silent) {
+            apxMsgW() << tr("NMT request dropped").append(':') << req->title();
         }
 
         // clear all node requests
-        cancel_requests(_request->node());
+        cancel_requests(node);
         return;
     }
 
-    _retry--;
-    if (!_request->silent) {
-        apxMsgW() << tr("NMT timeout").append(':') << _request->title()
+    it->retry--;
+    if (!req->silent) {
+        apxMsgW() << tr("NMT timeout").append(':') << req->title()
                   << QString("(%1/%2)")
-                         .arg(PApxNodeRequest::retries - _retry)
+                         .arg(PApxNodeRequest::retries - it->retry)
                          .arg(PApxNodeRequest::retries);
     }
 
-    _reqNext.start();
+    it->sent = false;
+    it->time = t + _reqDelay;
+    it->deadline = 0;
 }
 void PApxNodes::cancel_requests(PApxNode *node)
 {
     //qDebug() << node;
-    if (_request && (!node || _request->node() == node)) {
-        _reqTimeout.stop();
-        _request = nullptr;
-    }
-    for (auto req : _requests) {
+    if (node)
+        _slots.remove(node);
+    else
+        _slots.clear();
+
+    const auto list = _requests;
+    for (auto req : list) {
         if (node && req->node() != node)
             continue;
         _requests.removeOne(req);
@@ -252,7 +346,5 @@ void PApxNodes::cancel_requests(PApxNode *node)
     if (_requests.isEmpty()) {
         return;
     }
-
-    if (!_request)
-        request_next();
+    schedule(_time.elapsed());
 }
@@ -41,6 +41,10 @@ public:
 
     void cancel_requests(PApxNode *node);
 
+    static constexpr int window = 32;    // max nodes with requests in flight
+    static constexpr int req_rate = 100; // link budget for all vehicles [req/s]
+    static constexpr int req_burst = 10;
+
     PApxNode *getNode(QString uid, bool createNew = true);
 
 private:
@@ -48,12 +52,27 @@ private:
     QHash<QString, PApxNode *> _nodes;
     bool _local;
 
-    QTimer _reqTimeout;
-    QTimer _reqNext;
-
+    // one request in flight per node
+    struct slot_s
+    {
+        PApxNodeRequest *req;
+        uint retry;
+        bool sent;       // waiting for response when set
+        qint64 time;     // send, resend or timeout time [ms]
+        qint64 deadline; // timeout of windowed requests, zero when not sent
+    };
+    QHash<PApxNode *, slot_s> _slots;
     QList<PApxNodeRequest *> _requests;
-    PApxNodeRequest *_request{};
-    uint _retry{};
+
+    QElapsedTimer _time;
+    QTimer _reqTimer;
+    int _reqDelay{};
+    int _window{};
+
+    void schedule(qint64 time);
+    void fill_slots(qint64 t);
+    void send_request(PApxNode *node, qint64 t);
+    void timeout_request(PApxNode *node, qint64 t);
 
 protected:
     void requestSearch() override;
@@ -64,9 +83,7 @@ private slots:
     void request_finished(PApxNodeRequest *req);
     void request_extended(PApxNodeRequest *req, size_t time_ms);
 
-    void request_timeout();
-    void request_next();
-    void request_current();
+    void request_process();
 
     void updateActive();
 };
@@ -212,6 +212,7 @@ bool PApxTelemetry::unpack(uint8_t pseq, PStreamReader &stream)
 
     // collect updated values
     PBase::Values values;
+    values.reserve(static_cast<int>(decoder.slots_cnt()));
 
     for (size_t i = 0; i < decoder.slots_cnt(); ++i) {
         auto &flags = decoder.dec_slots().flags[i];
@@ -220,26 +221,28 @@ bool PApxTelemetry::unpack(uint8_t pseq, PStreamReader &stream)
         flags.upd = false;
         auto const &f = decoder.dec_slots().fields[i];
         auto const &value = decoder.dec_slots().value[i];
-        values.insert(f.pid.uid, raw_value(&value, flags.type));
+        values.insert(raw_value(f.pid.uid, &value, flags.type));
     }
 
     emit telemetryData(values, timestamp);
     return true;
 }
 
-QVariant PApxTelemetry::raw_value(const void *src, mandala::type_id_e type)
+PBase::Values::value_s PApxTelemetry::raw_value(mandala::uid_t uid,
+                                                 const void *src,
+                                                 mandala::type_id_e type)
 {
     switch (type) {
     case mandala::type_byte:
-        return QVariant::fromValue((uint) xbus::telemetry::raw_value<mandala::byte_t>(src, type));
+        return PBase::Values::make(uid, xbus::telemetry::raw_value<mandala::byte_t>(src, type));
     case mandala::type_word:
-        return QVariant::fromValue((uint) xbus::telemetry::raw_value<mandala::word_t>(src, type));
+        return PBase::Values::make(uid, xbus::telemetry::raw_value<mandala::word_t>(src, type));
     case mandala::type_dword:
-        return QVariant::fromValue(xbus::telemetry::raw_value<mandala::dword_t>(src, type));
+        return PBase::Values::make(uid, xbus::telemetry::raw_value<mandala::dword_t>(src, type));
     case mandala::type_real:
-        return QVariant::fromValue(xbus::telemetry::raw_value<mandala::real_t>(src, type));
+        return PBase::Values::make(uid, xbus::telemetry::raw_value<mandala::real_t>(src, type));
     }
-    return QVariant();
+    return PBase::Values::make(uid, QVariant());
 }
 
 void PApxTelemetry::request_format(uint8_t part)
@@ -49,7 +49,7 @@ private:
     uint32_t _dt_ms{};
 
     bool unpack(uint8_t pseq, PStreamReader &stream);
-    QVariant raw_value(const void *src, mandala::type_id_e type);
+    PBase::Values::value_s raw_value(mandala::uid_t uid, const void *src, mandala::type_id_e type);
 
     bool unpack_xpdr(PStreamReader &stream);
 
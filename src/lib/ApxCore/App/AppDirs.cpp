@@ -116,6 +116,11 @@ QDir AppDirs::db()
     return QDir(user().absoluteFilePath("Data"));
 }
 
+QDir AppDirs::telemetry()
+{
+    return QDir(db().absoluteFilePath("Telemetry"));
+}
+
 QDir AppDirs::logs()
 {
     return QDir(user().absoluteFilePath("Logs"));
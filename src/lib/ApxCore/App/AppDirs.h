@@ -41,6 +41,7 @@ public:
     static QDir configs();
     static QDir scripts();
     static QDir db();
+    static QDir telemetry();
     static QDir logs();
     static QDir video();
     static QDir images();
@@ -44,6 +44,7 @@ DatabaseRequest::DatabaseRequest(DatabaseSession *db,
     , bindValues(bindValues)
     , m_discarded(false)
 {
+    readOnly = queryString.trimmed().startsWith("SELECT", Qt::CaseInsensitive);
     connect(this,
             &DatabaseRequest::dbModified,
             db,
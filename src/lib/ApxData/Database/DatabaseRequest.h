@@ -40,10 +40,30 @@ public:
     };
     Q_ENUM(Status)
 
+    // worker queue lanes, served in this order
+    enum Priority {
+        Ingest = 0,  // live data stream
+        Interactive, // lookups and user edits
+        Bulk,        // cache rebuilds and maintenance
+    };
+    Q_ENUM(Priority)
+    static constexpr int PriorityCount = Bulk + 1;
+
+    Priority priority{Interactive};
+
+    // request doesn't modify the database and may run on a read-only connection
+    bool readOnly{false};
+
+    // thread the request was posted from, its requests are processed in order
+    QThread *requester{};
+
     virtual void exec();
     bool execSynchronous();
     bool isSynchronous;
 
+    // number of rows processed by run, used for worker rate stats
+    int rowsCount{1};
+
     void finish(bool error);
 
     bool discarded();
@@ -81,7 +81,14 @@ DatabaseSession::DatabaseSession(QObject *parent,
             //qDebug()<<"DB"<<sessionName<<"removed";
         });
     }
-    m_worker = new DatabaseWorker(this, nullptr);
+    m_worker = new DatabaseWorker(this);
+    if (sql.isOpen()) {
+        // WAL journal allows reads to run concurrently with the writer
+        for (int i = 0; i < 2; ++i) {
+            const QString cname = QString("%1_reader%2").arg(sessionName).arg(i);
+            m_readers.append(new DatabaseWorker(this, cname));
+        }
+    }
 
     modifiedTimer.setSingleShot(true);
     modifiedTimer.setInterval(500);
@@ -96,6 +103,13 @@ DatabaseSession::DatabaseSession(QObject *parent,
             &evtUpdateInfo,
             &DelayedEvent::schedule,
             Qt::QueuedConnection);
+    for (auto w : m_readers) {
+        connect(w,
+                &DatabaseWorker::infoChanged,
+                &evtUpdateInfo,
+                &DelayedEvent::schedule,
+                Qt::QueuedConnection);
+    }
 
     //tools
     f_vacuum = new Fact(this, "vacuum", tr("Optimize"), tr("Compress size"));
@@ -116,6 +130,8 @@ DatabaseSession::DatabaseSession(QObject *parent,
 DatabaseSession::~DatabaseSession()
 {
     m_workerLock.lockForWrite();
+    qDeleteAll(m_readers);
+    m_readers.clear();
     delete m_worker;
     m_worker = nullptr;
     m_workerLock.unlock();
@@ -126,7 +142,10 @@ DatabaseSession::~DatabaseSession()
 
 int DatabaseSession::queueSize()
 {
-    return m_worker->queueSize();
+    int qsz = m_worker->queueSize();
+    for (auto w : m_readers)
+        qsz += w->queueSize();
+    return qsz;
 }
 
 void DatabaseSession::modifiedNotify()
@@ -138,11 +157,13 @@ void DatabaseSession::updateInfo()
 {
     int qsz = queueSize();
     int rate = m_worker->rate();
+    for (auto w : m_readers)
+        rate += w->rate();
     QString size = qsz > 0 ? QString("%1 q").arg(qsz) : "";
     if (rate > 0) {
         if (!size.isEmpty())
             size.append(" | ");
-        size.append(QString("%1 qps").arg(rate));
+        size.append(QString("%1 rps").arg(rate));
     }
     setValue(size);
     if (rate > 0 || qsz != infoQueueSize)
@@ -230,7 +251,40 @@ void DatabaseSession::request(DatabaseRequest *req)
     QReadLocker locker(&m_workerLock);
     if (!sql.isOpen() || !m_worker || !enabled())
         return;
-    m_worker->request(req);
+    DatabaseWorker *worker = m_worker;
+    req->requester = QThread::currentThread();
+    {
+        QMutexLocker lock(&m_routesMutex);
+        route_s &r = m_routes[req->requester];
+        if (req->readOnly && !m_readers.isEmpty()) {
+            if (r.cnt > 0) {
+                // keep the order of requests posted by the same thread
+                worker = r.worker;
+            } else if (m_worker->idle()) {
+                // reads bypass the writer unless it has pending or uncommitted edits
+                worker = m_readers.first();
+                for (auto w : m_readers) {
+                    if (w->queueSize() < worker->queueSize())
+                        worker = w;
+                }
+            }
+        }
+        if (r.worker != worker) {
+            r.worker = worker;
+            r.cnt = 0;
+        }
+        r.cnt++;
+    }
+    worker->request(req);
+}
+void DatabaseSession::requestDone(DatabaseWorker *worker, QThread *requester)
+{
+    QMutexLocker lock(&m_routesMutex);
+    auto it = m_routes.find(requester);
+    if (it == m_routes.end() || it->worker != worker)
+        return;
+    if (--it->cnt <= 0)
+        m_routes.erase(it);
 }
 
 void DatabaseSession::vacuumTriggered()
@@ -52,6 +52,7 @@ public:
     void enable();
 
     void request(DatabaseRequest *req);
+    void requestDone(DatabaseWorker *worker, QThread *requester); // called by workers
 
     bool transaction(QSqlQuery &query);
     bool commit(QSqlQuery &query, bool forceError = false);
@@ -73,8 +74,18 @@ protected:
 protected:
     Database *database;
     DatabaseWorker *m_worker;
+    QList<DatabaseWorker *> m_readers; // read-only connections pool
     QReadWriteLock m_workerLock;
 
+    // worker of each requester thread while it has requests in flight
+    struct route_s
+    {
+        DatabaseWorker *worker;
+        int cnt;
+    };
+    QHash<QThread *, route_s> m_routes;
+    QMutex m_routesMutex;
+
 private:
     QTimer modifiedTimer;
 
@@ -157,7 +168,9 @@ public:
     explicit DBReqVacuum(DatabaseSession *db)
         : DatabaseRequest(db)
         , name(QFileInfo(db->fileName).baseName())
-    {}
+    {
+        priority = Bulk;
+    }
 
 protected:
     bool run(QSqlQuery &query);
@@ -172,7 +185,9 @@ public:
     explicit DBReqAnalyze(DatabaseSession *db)
         : DatabaseRequest(db)
         , name(QFileInfo(db->fileName).baseName())
-    {}
+    {
+        priority = Bulk;
+    }
 
 protected:
     bool run(QSqlQuery &query);
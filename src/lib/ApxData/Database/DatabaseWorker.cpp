@@ -23,11 +23,14 @@
 #include "DatabaseSession.h"
 #include <App/AppLog.h>
 
-DatabaseWorker::DatabaseWorker(DatabaseSession *db, QObject *parent)
+DatabaseWorker::DatabaseWorker(DatabaseSession *db,
+                               const QString &connectionName,
+                               QObject *parent)
     : QThread(parent)
     , db(db)
+    , m_connectionName(connectionName)
 {
-    setObjectName(db->sessionName.append("_worker"));
+    setObjectName(readOnly() ? connectionName : QString("%1_worker").arg(db->sessionName));
 
     rcnt = m_rate = 0;
     infoUpdateTime.start();
@@ -37,14 +40,34 @@ DatabaseWorker::~DatabaseWorker()
 {
     requestInterruption();
     waitCondition.notify_all();
+    queueNotFull.notify_all();
     qDebug() << "Finishing" << objectName() << queueSize();
     wait();
 }
 void DatabaseWorker::run()
 {
+    if (!readOnly()) {
+        process(db->sql);
+        return;
+    }
+    {
+        // connections must be used by the thread which created them
+        QSqlDatabase sql = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        sql.setDatabaseName(db->fileName);
+        sql.setConnectOptions("QSQLITE_OPEN_READONLY; QSQLITE_BUSY_TIMEOUT=10000000");
+        if (!sql.open())
+            apxConsoleW() << objectName() << sql.lastError();
+        process(sql);
+        sql.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+void DatabaseWorker::process(QSqlDatabase &sql)
+{
+    const bool writer = !readOnly();
     bool bEmpty = true;
     uint qcnt = 0;
-    QSqlQuery query(db->sql);
+    QSqlQuery query(sql);
     query.setForwardOnly(true);
 
     while (!isInterruptionRequested()) {
@@ -52,26 +75,24 @@ void DatabaseWorker::run()
         if (queueSize() == 0) {
             queueMutex.lockForRead();
             waitCondition.wait(&queueMutex, 1000);
-            bool empty = queue.empty();
+            bool empty = m_queueSize == 0;
             queueMutex.unlock();
             if (empty) {
                 infoUpdate(true);
                 continue;
             }
         }
-        //take next request from queue
-        queueMutex.lockForWrite();
-        DatabaseRequest *req = queue.front();
-        queue.pop_front();
-        queueMutex.unlock();
-        rcnt++;
+        //take next request from the highest priority lane
+        DatabaseRequest *req = dequeue();
         infoUpdate(false);
         if (!req)
             continue;
+        QThread *requester = req->requester;
         if (req->discarded()) {
             req->finish(false);
             if (!req->isSynchronous)
                 delete req; //->deleteLater();
+            done(requester);
             continue;
         }
         //process request
@@ -80,59 +101,104 @@ void DatabaseWorker::run()
         } else {
             qcnt++;
         }
-        if (!db->inTransaction)
+        if (writer && !db->inTransaction) {
+            //results emitted by run() may trigger reads of uncommitted data
+            m_uncommitted = true;
             db->transaction(query); //begin if not already
+        }
         bool rv = req->run(query);
         if (!rv) {
             apxConsoleW() << "query error:" << query.lastError().text() << query.lastQuery() << req;
-            db->commit(query, true);
-        } else if (req->discarded()) {
+            if (writer) {
+                db->commit(query, true);
+                m_uncommitted = false;
+            }
+        } else if (writer && req->discarded()) {
             db->rollback(query);
         }
+        //only live ingest is batched in one transaction,
+        //other writes must become visible to readers when finished
+        bool bCommit = req->priority != DatabaseRequest::Ingest;
+        rcnt += req->rowsCount;
         req->finish(!rv);
         query.finish();
 
         if (!req->isSynchronous)
             delete req; //req->deleteLater();
+        done(requester);
 
-        queueMutex.lockForRead();
-        bEmpty = queue.empty();
-        queueMutex.unlock();
+        bEmpty = queueSize() == 0;
 
-        if (bEmpty || qcnt > 200) {
+        if (writer && (bEmpty || bCommit || qcnt > 200)) {
             qcnt = 0;
             db->commit(query);
             query.finish();
+            m_uncommitted = false;
             //qDebug()<<"empty";
         }
     }
     QWriteLocker locker(&queueMutex);
-    for (auto req : queue) {
-        req->discard();
-        req->finish(false);
-        if (!req->isSynchronous)
-            delete req; //req->deleteLater();
+    for (auto &q : queue) {
+        for (auto req : q) {
+            req->discard();
+            req->finish(false);
+            if (!req->isSynchronous)
+                delete req; //req->deleteLater();
+        }
+        q.clear();
     }
-    queue.clear();
+    m_queueSize = 0;
+    m_pending = 0;
+    queueNotFull.wakeAll();
 }
 
 void DatabaseWorker::request(DatabaseRequest *req)
 {
-    if (req && !isInterruptionRequested()) {
-        enqueue(req);
-        //qDebug()<<sz;
-        waitCondition.wakeAll();
-        //wait for long queues
-        while (!isInterruptionRequested() && queueSize() >= 100000) {
-            usleep(1000);
-        }
+    if (!req || isInterruptionRequested())
+        return;
+    QWriteLocker lock(&queueMutex);
+    queue[req->priority].push_back(req);
+    m_queueSize++;
+    m_pending++;
+    waitCondition.wakeAll();
+    //wait for long queues, requests posted from the worker thread itself are never blocked
+    if (QThread::currentThread() == this)
+        return;
+    while (!isInterruptionRequested() && m_queueSize >= queueLimit) {
+        queueNotFull.wait(&queueMutex, 1000);
     }
 }
 
+DatabaseRequest *DatabaseWorker::dequeue()
+{
+    QWriteLocker lock(&queueMutex);
+    for (auto &q : queue) {
+        if (q.empty())
+            continue;
+        DatabaseRequest *req = q.front();
+        q.pop_front();
+        if (--m_queueSize == queueLimit - 1)
+            queueNotFull.wakeAll();
+        return req;
+    }
+    return nullptr;
+}
+
+void DatabaseWorker::done(QThread *requester)
+{
+    m_pending--;
+    db->requestDone(this, requester);
+}
+
 int DatabaseWorker::queueSize()
 {
     QReadLocker lock(&queueMutex);
-    return queue.size();
+    return m_queueSize;
+}
+int DatabaseWorker::queueSize(DatabaseRequest::Priority priority)
+{
+    QReadLocker lock(&queueMutex);
+    return queue[priority].size();
 }
 int DatabaseWorker::rate()
 {
@@ -157,15 +223,3 @@ bool DatabaseWorker::infoUpdate(bool force)
     emit infoChanged();
     return true;
 }
-
-void DatabaseWorker::enqueue(DatabaseRequest *req)
-{
-    QWriteLocker lock(&queueMutex);
-    queue.push_back(req);
-}
-
-void DatabaseWorker::eraseRequests(int count)
-{
-    QWriteLocker lock(&queueMutex);
-    queue.erase(queue.begin(), queue.begin() + count);
-}
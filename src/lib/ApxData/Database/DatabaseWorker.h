@@ -22,6 +22,7 @@
 #pragma once
 
 #include "DatabaseRequest.h"
+#include <array>
 #include <atomic>
 #include <deque>
 #include <QtCore>
@@ -33,31 +34,53 @@ class DatabaseWorker : public QThread
     Q_OBJECT
 
 public:
-    explicit DatabaseWorker(DatabaseSession *db, QObject *parent = nullptr);
+    // empty connectionName - use session connection for writes,
+    // otherwise open own read-only connection to the session file
+    explicit DatabaseWorker(DatabaseSession *db,
+                            const QString &connectionName = QString(),
+                            QObject *parent = nullptr);
     ~DatabaseWorker() override;
 
     void request(DatabaseRequest *req);
 
     int queueSize();
-    int rate();
+    int queueSize(DatabaseRequest::Priority priority);
+    int rate(); // processed rows per second
+
+    bool readOnly() const { return !m_connectionName.isEmpty(); }
+
+    // writer has changes not yet visible to reader connections
+    bool uncommitted() const { return m_uncommitted; }
+
+    // no queued or running requests in any lane and everything committed
+    bool idle() const { return m_pending == 0 && !m_uncommitted; }
 
 protected:
     void run() override;
 
 private:
     DatabaseSession *db;
+    QString m_connectionName;
 
-    std::deque<DatabaseRequest *> queue;
+    std::array<std::deque<DatabaseRequest *>, DatabaseRequest::PriorityCount> queue;
+    int m_queueSize{};
     QReadWriteLock queueMutex;
     QWaitCondition waitCondition;
+    QWaitCondition queueNotFull; // producers back-pressure
+    static constexpr int queueLimit = 100000;
+
+    std::atomic_bool m_uncommitted{};
+    std::atomic_int m_pending{}; // queued and running requests
+
+    void process(QSqlDatabase &sql);
+    DatabaseRequest *dequeue();
+    void done(QThread *requester);
 
     //info
     int rcnt;
     std::atomic_int m_rate;
     QElapsedTimer infoUpdateTime;
     bool infoUpdate(bool force);
-    void enqueue(DatabaseRequest *req);
-    void eraseRequests(int count);
 
 signals:
     void infoChanged();
@@ -0,0 +1,184 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "NodeDictCache.h"
+
+#include <App/App.h>
+
+NodeDictCache::NodeDictCache(QObject *parent, QString fileName)
+    : QObject(parent)
+    , _fileName(fileName)
+    , _file(fileName)
+{
+    _saveTimer.setSingleShot(true);
+    _saveTimer.setInterval(1000);
+    connect(&_saveTimer, &QTimer::timeout, this, &NodeDictCache::save);
+    connect(App::instance(), &App::aboutToQuit, this, &NodeDictCache::save);
+
+    load();
+}
+NodeDictCache::~NodeDictCache()
+{
+    save();
+    unmap();
+}
+
+void NodeDictCache::load()
+{
+    if (!_file.open(QFile::ReadOnly))
+        return;
+
+    qint64 size = _file.size();
+    _map = _file.map(0, size);
+    if (!_map) {
+        _file.close();
+        return;
+    }
+
+    // records refer to the mapped data until the file is rewritten
+    QByteArray ba(QByteArray::fromRawData(reinterpret_cast<const char *>(_map),
+                                          static_cast<int>(size)));
+    QDataStream stream(ba);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 v_magic, v_version, cnt;
+    stream >> v_magic >> v_version >> cnt;
+    if (stream.status() != QDataStream::Ok || v_magic != magic || v_version != version) {
+        qWarning() << "invalid cache" << _fileName;
+        unmap();
+        return;
+    }
+
+    for (quint32 i = 0; i < cnt; ++i) {
+        quint32 hash, dsize;
+        quint64 time;
+        stream >> hash >> time >> dsize;
+        if (stream.status() != QDataStream::Ok)
+            break;
+        qint64 pos = stream.device()->pos();
+        if (pos + dsize > size)
+            break;
+        auto data = QByteArray::fromRawData(ba.constData() + pos, static_cast<int>(dsize));
+        _entries.insert(hash, {data, time});
+        stream.skipRawData(static_cast<int>(dsize));
+    }
+}
+
+void NodeDictCache::unmap()
+{
+    if (_map) {
+        // detach records from the mapped file
+        for (auto &i : _entries)
+            i.data = QByteArray(i.data.constData(), i.data.size());
+        _file.unmap(_map);
+        _map = nullptr;
+    }
+    _file.close();
+}
+
+QVariantMap NodeDictCache::dict(xbus::node::hash_t hash)
+{
+    QMutexLocker lock(&_mutex);
+
+    auto it = _entries.find(hash);
+    if (it == _entries.end())
+        return {};
+
+    QVariantMap dict;
+    QDataStream stream(it->data);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream >> dict;
+    if (stream.status() != QDataStream::Ok || dict.isEmpty()) {
+        qWarning() << "invalid dict" << hash;
+        _entries.erase(it);
+        return {};
+    }
+    it->time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch());
+
+    dict.insert("cached", true);
+    return dict;
+}
+
+void NodeDictCache::insert(const QVariantMap &dict)
+{
+    bool ok = false;
+    xbus::node::hash_t hash = dict.value("hash").toString().toUInt(&ok, 16);
+    if (!ok || dict.value("fields").value<QVariantList>().isEmpty())
+        return;
+
+    QVariantMap d(dict);
+    d.remove("cached");
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << d;
+
+    auto time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch());
+
+    QMutexLocker lock(&_mutex);
+
+    auto it = _entries.find(hash);
+    if (it != _entries.end() && it->data == data) {
+        it->time = time;
+        return;
+    }
+    _entries.insert(hash, {data, time});
+
+    // drop least recently used
+    while (_entries.size() > max_entries) {
+        auto lru = _entries.begin();
+        for (auto i = _entries.begin(); i != _entries.end(); ++i) {
+            if (i->time < lru->time)
+                lru = i;
+        }
+        _entries.erase(lru);
+    }
+
+    _modified = true;
+    QMetaObject::invokeMethod(this, [this]() { _saveTimer.start(); });
+}
+
+void NodeDictCache::save()
+{
+    QMutexLocker lock(&_mutex);
+    if (!_modified)
+        return;
+    _modified = false;
+
+    unmap();
+
+    QSaveFile file(_fileName);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << file.errorString() << _fileName;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << magic << version << static_cast<quint32>(_entries.size());
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        stream << static_cast<quint32>(it.key()) << it->time
+               << static_cast<quint32>(it->data.size());
+        stream.writeRawData(it->data.constData(), it->data.size());
+    }
+    if (!file.commit())
+        qWarning() << file.errorString() << _fileName;
+}
@@ -0,0 +1,67 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QtCore>
+
+#include <XbusNode.h>
+
+class NodeDictCache : public QObject
+{
+    // node dictionaries by hash, kept in memory and in a mapped file
+
+    Q_OBJECT
+public:
+    explicit NodeDictCache(QObject *parent, QString fileName);
+    ~NodeDictCache() override;
+
+    // thread safe, used by nodes and database requests
+    QVariantMap dict(xbus::node::hash_t hash);
+    void insert(const QVariantMap &dict);
+
+    static constexpr int max_entries = 256;
+
+private:
+    struct entry_s
+    {
+        QByteArray data; // serialized dict, may refer to the mapped file
+        quint64 time;    // last used
+    };
+    QHash<xbus::node::hash_t, entry_s> _entries;
+    QMutex _mutex;
+
+    QString _fileName;
+    QFile _file;
+    uchar *_map{};
+
+    QTimer _saveTimer;
+    bool _modified{};
+
+    static constexpr quint32 magic = 0x44585041; // APXD
+    static constexpr quint32 version = 1;
+
+    void load();
+    void unmap();
+
+private slots:
+    void save();
+};
@@ -71,7 +71,8 @@ TelemetryDB::TelemetryDB(QObject *parent, QString sessionName)
                                      << "downlink INTEGER"
                                      << "uplink INTEGER"
                                      << "events INTEGER"
-                                     << "evtDetails TEXT");
+                                     << "evtDetails TEXT"
+                                     << "file TEXT"); //binary data file name
     new DBReqMakeIndex(this, "Telemetry", "trash", false);
     new DBReqMakeIndex(this, "Telemetry", "time", false);
     new DBReqMakeIndex(this, "Telemetry", "vehicleUID", false);
@@ -147,6 +148,7 @@ TelemetryDB::TelemetryDB(QObject *parent, QString sessionName)
                                      << "telemetryID INTEGER NOT NULL UNIQUE"
                                      << "time INTEGER"    //access time
                                      << "records INTEGER" //count
+                                     << "size INTEGER"    //binary file size
                                      << "FOREIGN KEY(telemetryID) REFERENCES Telemetry(key) ON "
                                         "DELETE CASCADE ON UPDATE CASCADE");
     new DBReqMakeIndex(this, "TelemetryCache", "telemetryID", false);
@@ -210,6 +212,11 @@ mandala::uid_t TelemetryDB::mandala_uid(quint64 field_key)
     return _fieldsByUID.key(field_key);
 }
 
+QDir TelemetryDB::cacheDir()
+{
+    return QDir(AppDirs::db().absoluteFilePath("TelemetryCache"));
+}
+
 void TelemetryDB::markCacheInvalid(quint64 telemetryID)
 {
     if (latestInvalidCacheID == telemetryID)
@@ -463,6 +470,7 @@ bool DBReqTelemetryEmptyTrash::run(QSqlQuery &query)
                     break;
                 if (!db->commit(query))
                     break;
+                TelemetryDB::cacheDir().remove(QString::number(key));
 
                 dcnt++;
                 emit progress((dcnt * 100 / cnt));
@@ -522,6 +530,11 @@ bool DBReqTelemetryEmptyCache::run(QSqlQuery &query)
                     break;
             }
         }
+        //columnar cache files
+        QDir dir(TelemetryDB::cacheDir());
+        for (auto const &s : dir.entryList(QDir::Files))
+            dir.remove(s);
+
         if (dcnt < cnt)
             apxMsgW() << tr("Telemetry cache not empty") << cnt - dcnt;
         else {
@@ -30,6 +30,9 @@ class TelemetryDB : public DatabaseSession
 public:
     explicit TelemetryDB(QObject *parent, QString sessionName);
 
+    // columnar records cache files location
+    static QDir cacheDir();
+
     void markCacheInvalid(quint64 telemetryID);
     QList<quint64> invalidCacheList();
     void clearInvalidCacheList();
@@ -104,7 +107,9 @@ class DBReqTelemetryEmptyTrash : public DBReqTelemetry
 public:
     explicit DBReqTelemetryEmptyTrash()
         : DBReqTelemetry()
-    {}
+    {
+        priority = Bulk;
+    }
 
 protected:
     bool run(QSqlQuery &query);
@@ -118,7 +123,9 @@ class DBReqTelemetryEmptyCache : public DBReqTelemetry
 public:
     explicit DBReqTelemetryEmptyCache()
         : DBReqTelemetry()
-    {}
+    {
+        priority = Bulk;
+    }
 
 protected:
     bool run(QSqlQuery &query);
@@ -68,6 +68,7 @@ enum class extid_e { // 4 bits
     ts = 0, // [ms] u32 timestamp update relative to file
     fields, // [names...,0] strings of used fields sequence
     crc,    // [crc32] counted so far for the data stream
+    uplink, // [ts,dspec16,value] uplink field value
 
     // events
     evt = 8, // [ts,uplink,name,value,uid,0] event data
@@ -105,4 +106,25 @@ static_assert(sizeof(dspec_s) == 2, "size error");
 
 #pragma pack()
 
+// file format identification
+static constexpr const char *magic = "APXTLM11";
+static constexpr uint16_t version = 11;
+static constexpr const char *suffix = "apxtlm";
+
+// max index of variable in the sequence (11 bits)
+static constexpr uint vidx_max = (1 << 11) - 1;
+
+// crc32 running state of the data stream (no final xor)
+static constexpr uint32_t crc32_init = 0xFFFFFFFF;
+inline uint32_t crc32(const void *data, size_t sz, uint32_t crc)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while (sz--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; ++i)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return crc;
+}
+
 } // namespace telemetry
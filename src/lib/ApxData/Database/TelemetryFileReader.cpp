@@ -0,0 +1,521 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TelemetryFileReader.h"
+#include "TelemetryFileFormat.h"
+
+#include <App/AppLog.h>
+
+#include <QFloat16>
+
+using namespace telemetry;
+
+// seek index granularity [ms]
+#define TELEMETRY_INDEX_INTERVAL 1000
+// fields values snapshots interval [ms]
+#define TELEMETRY_SNAPSHOT_INTERVAL 30000
+
+TelemetryFileReader::TelemetryFileReader() {}
+
+TelemetryFileReader::~TelemetryFileReader()
+{
+    close();
+}
+
+bool TelemetryFileReader::open(const QString &fileName)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        apxConsoleW() << "telemetry file:" << _file.errorString() << fileName;
+        return false;
+    }
+    const qint64 fsize = _file.size();
+    if (fsize < static_cast<qint64>(sizeof(fhdr_s))
+        || fsize > std::numeric_limits<quint32>::max()) {
+        apxConsoleW() << "telemetry file size:" << fsize << fileName;
+        close();
+        return false;
+    }
+    _data = _file.map(0, fsize);
+    if (!_data) {
+        apxConsoleW() << "telemetry file map:" << _file.errorString() << fileName;
+        close();
+        return false;
+    }
+    _size = static_cast<quint32>(fsize);
+
+    fhdr_s fhdr;
+    memcpy(&fhdr, _data, sizeof(fhdr));
+    if (strncmp(fhdr.magic.magic, telemetry::magic, sizeof(fhdr.magic.magic)) != 0
+        || fhdr.magic.version != telemetry::version) {
+        apxConsoleW() << "telemetry file format:" << fileName;
+        close();
+        return false;
+    }
+    if (fhdr.data_offset < sizeof(fhdr) || fhdr.data_offset > _size) {
+        apxConsoleW() << "telemetry file data offset:" << fhdr.data_offset << fileName;
+        close();
+        return false;
+    }
+    _data_offset = fhdr.data_offset;
+    if (fhdr.aux_offset > _data_offset && fhdr.aux_offset < _size)
+        _size = fhdr.aux_offset;
+
+    _ts_file = fhdr.ts_file;
+
+    const char *tags = fhdr.tags;
+    const char *tags_end = fhdr.tags + sizeof(fhdr.tags);
+    while (tags < tags_end && *tags) {
+        const size_t len = strnlen(tags, static_cast<size_t>(tags_end - tags));
+        _tags.append(QString::fromUtf8(tags, static_cast<int>(len)));
+        tags += len + 1;
+    }
+
+    if (!build_index()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TelemetryFileReader::close()
+{
+    if (_data)
+        _file.unmap(const_cast<uchar *>(_data));
+    _data = nullptr;
+    _file.close();
+
+    _size = _data_offset = 0;
+    _ts_file = 0;
+    _ts_max = 0;
+    _tags.clear();
+    _fields.clear();
+    _values_cnt = _events_cnt = 0;
+    _field_cnt.clear();
+    _cur = {};
+    _index.clear();
+    _snapshots.clear();
+    _events.clear();
+}
+
+bool TelemetryFileReader::build_index()
+{
+    _indexing = true;
+    _crc = crc32_init;
+    _crc_pos = _data_offset;
+
+    cursor_s cur{_data_offset, 0, -1};
+    QVector<double> values;
+    record_s rec{};
+
+    bool first = true;
+    quint32 ts_index = 0;
+    quint32 ts_snapshot = 0;
+
+    for (;;) {
+        const cursor_s prev = cur;
+        if (!decode(cur, &rec, false))
+            break;
+
+        if (rec.ts > _ts_max)
+            _ts_max = rec.ts;
+
+        if (rec.type == rec_e::value || rec.type == rec_e::uplink) {
+            if (static_cast<int>(rec.vidx) >= _field_cnt.size())
+                _field_cnt.resize(static_cast<int>(rec.vidx) + 1);
+            _field_cnt[static_cast<int>(rec.vidx)]++;
+        }
+        if (rec.type != rec_e::value) {
+            _events.append(rec.pos);
+            _events_cnt++;
+            continue;
+        }
+        _values_cnt++;
+
+        if (first || rec.ts >= (ts_index + TELEMETRY_INDEX_INTERVAL)) {
+            index_s idx{rec.ts, prev, -1};
+            if (first || rec.ts >= (ts_snapshot + TELEMETRY_SNAPSHOT_INTERVAL)) {
+                idx.snapshot = _snapshots.size();
+                _snapshots.append(values);
+                ts_snapshot = rec.ts;
+            }
+            _index.append(idx);
+            ts_index = rec.ts;
+            first = false;
+        }
+
+        if (rec.null)
+            continue;
+        if (static_cast<int>(rec.vidx) >= values.size()) {
+            const int sz = values.size();
+            values.resize(static_cast<int>(rec.vidx) + 1);
+            std::fill(values.begin() + sz, values.end(), qQNaN());
+        }
+        values[static_cast<int>(rec.vidx)] = rec.value;
+    }
+    _indexing = false;
+
+    // ignore the rest of data if the stream is broken
+    if (cur.pos < _size) {
+        apxConsoleW() << "telemetry file data error at:" << cur.pos << _file.fileName();
+        _size = cur.pos;
+    }
+
+    _cur = {_data_offset, 0, -1};
+    return true;
+}
+
+int TelemetryFileReader::index_lookup(quint32 ts) const
+{
+    // last index entry with time not greater than ts
+    auto it = std::upper_bound(_index.begin(),
+                               _index.end(),
+                               ts,
+                               [](quint32 v, const index_s &i) { return v < i.ts; });
+    return static_cast<int>(it - _index.begin()) - 1;
+}
+
+bool TelemetryFileReader::seek(quint32 ts)
+{
+    if (!isOpen())
+        return false;
+
+    const int i = index_lookup(ts);
+    cursor_s cur = i < 0 ? cursor_s{_data_offset, 0, -1} : _index.at(i).cur;
+
+    record_s rec{};
+    for (;;) {
+        const cursor_s prev = cur;
+        if (!decode(cur, &rec, false)) {
+            _cur = cur;
+            return false;
+        }
+        if (rec.ts >= ts) {
+            _cur = prev;
+            return true;
+        }
+    }
+}
+
+bool TelemetryFileReader::next(record_s *rec, bool skip_values)
+{
+    if (!isOpen())
+        return false;
+    return decode(_cur, rec, skip_values);
+}
+
+QVector<double> TelemetryFileReader::values_at(quint32 ts)
+{
+    QVector<double> values(_fields.size(), qQNaN());
+    if (!isOpen())
+        return values;
+
+    cursor_s cur{_data_offset, 0, -1};
+    for (int i = index_lookup(ts); i >= 0; --i) {
+        const index_s &idx = _index.at(i);
+        if (idx.snapshot < 0)
+            continue;
+        const QVector<double> &snapshot = _snapshots.at(idx.snapshot);
+        std::copy(snapshot.begin(), snapshot.end(), values.begin());
+        cur = idx.cur;
+        break;
+    }
+
+    record_s rec{};
+    while (decode(cur, &rec, false)) {
+        if (rec.ts > ts)
+            break;
+        if (rec.type != rec_e::value || rec.null)
+            continue;
+        values[static_cast<int>(rec.vidx)] = rec.value;
+    }
+    return values;
+}
+
+QList<TelemetryFileReader::record_s> TelemetryFileReader::events_until(quint32 ts)
+{
+    QList<record_s> list;
+    record_s rec{};
+    for (auto pos : _events) {
+        cursor_s cur{pos, 0, -1};
+        if (!decode(cur, &rec, true))
+            break;
+        if (rec.ts > ts)
+            break;
+        list.append(rec);
+    }
+    return list;
+}
+
+bool TelemetryFileReader::decode(cursor_s &cur, record_s *rec, bool skip_values)
+{
+    while (cur.pos < _size) {
+        const quint32 rpos = cur.pos;
+        quint32 pos = rpos;
+
+        dspec_s spec{};
+        spec._raw8 = _data[pos++];
+
+        if (spec.spec_ext.dspec == dspec_e::ext) {
+            switch (spec.spec_ext.extid) {
+            default:
+                return false;
+
+            case extid_e::ts:
+                if ((pos + sizeof(quint32)) > _size)
+                    return false;
+                cur.ts = qFromLittleEndian<quint32>(_data + pos);
+                cur.pos = pos + sizeof(quint32);
+                continue;
+
+            case extid_e::crc: {
+                if ((pos + sizeof(quint32)) > _size)
+                    return false;
+                if (_indexing) {
+                    _crc = telemetry::crc32(_data + _crc_pos, rpos - _crc_pos, _crc);
+                    _crc_pos = rpos;
+                    if (_crc != qFromLittleEndian<quint32>(_data + pos)) {
+                        apxConsoleW() << "telemetry file crc error at:" << rpos;
+                        return false;
+                    }
+                }
+                cur.pos = pos + sizeof(quint32);
+                continue;
+            }
+
+            case extid_e::fields: {
+                // names list terminated by empty string
+                QString s;
+                for (;;) {
+                    if (pos >= _size)
+                        return false;
+                    if (_data[pos] == 0) {
+                        pos++;
+                        break;
+                    }
+                    if (!read_string(pos, _indexing ? &s : nullptr))
+                        return false;
+                    if (_indexing)
+                        _fields.append(s);
+                }
+                cur.pos = pos;
+                continue;
+            }
+
+            case extid_e::file:
+                // [name, json_base64_zip]
+                if (!read_string(pos, nullptr) || !read_string(pos, nullptr))
+                    return false;
+                cur.pos = pos;
+                continue;
+
+            case extid_e::uplink: {
+                // [ts,dspec16,value], keeps the downlink index delta
+                if ((pos + sizeof(quint32) + sizeof(quint16)) > _size)
+                    return false;
+                const quint32 ts = qFromLittleEndian<quint32>(_data + pos);
+                pos += sizeof(quint32);
+                dspec_s vspec{};
+                vspec._raw16 = qFromLittleEndian<quint16>(_data + pos);
+                pos += sizeof(quint16);
+                if (vspec.spec16.opt || vspec.spec16.vidx >= static_cast<uint>(_fields.size()))
+                    return false;
+                double v = 0;
+                bool null = false;
+                if (!read_value(pos, static_cast<uint8_t>(vspec.spec16.dspec), &v, &null))
+                    return false;
+                cur.pos = pos;
+                rec->type = rec_e::uplink;
+                rec->pos = rpos;
+                rec->ts = ts;
+                rec->vidx = vspec.spec16.vidx;
+                rec->value = v;
+                rec->null = null;
+                rec->uplink = true;
+                return true;
+            }
+
+            case extid_e::evt:
+            case extid_e::msg: {
+                const bool is_evt = spec.spec_ext.extid == extid_e::evt;
+                if ((pos + sizeof(quint32) + (is_evt ? 1 : 0)) > _size)
+                    return false;
+                rec->type = is_evt ? rec_e::evt : rec_e::msg;
+                rec->pos = rpos;
+                rec->ts = qFromLittleEndian<quint32>(_data + pos);
+                pos += sizeof(quint32);
+                rec->uplink = is_evt ? _data[pos++] != 0 : false;
+                if (is_evt) {
+                    if (!read_string(pos, &rec->name))
+                        return false;
+                } else {
+                    rec->name = "msg";
+                }
+                if (!read_string(pos, &rec->text) || !read_string(pos, &rec->uid))
+                    return false;
+                cur.pos = pos;
+                return true;
+            }
+            }
+        }
+
+        // value record
+        uint vidx;
+        if (spec.spec8.opt) {
+            vidx = static_cast<uint>(cur.vidx + 1) + spec.spec8.vidx_delta;
+        } else {
+            if (pos >= _size)
+                return false;
+            spec._raw16 = qFromLittleEndian<quint16>(_data + rpos);
+            vidx = spec.spec16.vidx;
+            pos++;
+        }
+        if (vidx >= static_cast<uint>(_fields.size()))
+            return false;
+
+        double v = 0;
+        bool null = false;
+        if (!read_value(pos, static_cast<uint8_t>(spec.spec8.dspec), &v, &null))
+            return false;
+
+        cur.pos = pos;
+        cur.vidx = static_cast<int>(vidx);
+
+        if (skip_values)
+            continue;
+
+        rec->type = rec_e::value;
+        rec->pos = rpos;
+        rec->ts = cur.ts;
+        rec->vidx = vidx;
+        rec->value = v;
+        rec->null = null;
+        return true;
+    }
+    return false;
+}
+
+bool TelemetryFileReader::read_value(quint32 &pos, uint8_t dspec, double *v, bool *null)
+{
+    size_t sz;
+    switch (static_cast<dspec_e>(dspec)) {
+    default:
+        return false;
+    case dspec_e::null:
+        sz = 0;
+        break;
+    case dspec_e::u8:
+        sz = 1;
+        break;
+    case dspec_e::u16:
+    case dspec_e::f16:
+    case dspec_e::a16:
+        sz = 2;
+        break;
+    case dspec_e::u24:
+        sz = 3;
+        break;
+    case dspec_e::u32:
+    case dspec_e::f32:
+    case dspec_e::a32:
+        sz = 4;
+        break;
+    case dspec_e::u64:
+    case dspec_e::f64:
+        sz = 8;
+        break;
+    }
+    if ((pos + sz) > _size)
+        return false;
+
+    const uchar *p = _data + pos;
+    pos += static_cast<quint32>(sz);
+    *null = false;
+
+    switch (static_cast<dspec_e>(dspec)) {
+    default:
+        return false;
+    case dspec_e::null:
+        *null = true;
+        *v = 0;
+        break;
+    case dspec_e::u8:
+        *v = *p;
+        break;
+    case dspec_e::u16:
+        *v = qFromLittleEndian<quint16>(p);
+        break;
+    case dspec_e::u24:
+        *v = qFromLittleEndian<quint16>(p) | (static_cast<quint32>(p[2]) << 16);
+        break;
+    case dspec_e::u32:
+        *v = qFromLittleEndian<quint32>(p);
+        break;
+    case dspec_e::u64:
+        *v = static_cast<double>(qFromLittleEndian<quint64>(p));
+        break;
+    case dspec_e::f16: {
+        const quint16 raw = qFromLittleEndian<quint16>(p);
+        qfloat16 h;
+        memcpy(&h, &raw, sizeof(h));
+        *v = static_cast<float>(h);
+        break;
+    }
+    case dspec_e::f32: {
+        const quint32 raw = qFromLittleEndian<quint32>(p);
+        float f;
+        memcpy(&f, &raw, sizeof(f));
+        *v = f;
+        break;
+    }
+    case dspec_e::f64: {
+        const quint64 raw = qFromLittleEndian<quint64>(p);
+        double d;
+        memcpy(&d, &raw, sizeof(d));
+        *v = d;
+        break;
+    }
+    case dspec_e::a16:
+        *v = static_cast<qint16>(qFromLittleEndian<quint16>(p)) * (180.0 / 32768.0);
+        break;
+    case dspec_e::a32:
+        *v = static_cast<qint32>(qFromLittleEndian<quint32>(p)) * (180.0 / 2147483648.0);
+        break;
+    }
+    return true;
+}
+
+bool TelemetryFileReader::read_string(quint32 &pos, QString *s)
+{
+    if (pos >= _size)
+        return false;
+    const char *p = reinterpret_cast<const char *>(_data + pos);
+    const void *end = memchr(p, 0, _size - pos);
+    if (!end)
+        return false;
+    const quint32 len = static_cast<quint32>(static_cast<const char *>(end) - p);
+    if (s)
+        *s = QString::fromUtf8(p, static_cast<int>(len));
+    pos += len + 1;
+    return true;
+}
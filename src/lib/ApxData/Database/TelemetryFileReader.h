@@ -0,0 +1,134 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QtCore>
+
+// Memory mapped APXTLM11 telemetry file reader with sparse seek index
+class TelemetryFileReader
+{
+public:
+    explicit TelemetryFileReader();
+    ~TelemetryFileReader();
+
+    enum class rec_e {
+        none,
+        value,
+        uplink,
+        evt,
+        msg,
+    };
+
+    struct record_s
+    {
+        rec_e type;
+        quint32 ts;  // [ms] relative to file
+        quint32 pos; // record offset in file
+
+        // value and uplink data
+        uint vidx;
+        double value;
+        bool null;
+
+        // events and messages
+        bool uplink;
+        QString name;
+        QString text;
+        QString uid;
+    };
+
+    // decodes the whole data stream once to build the index, fields and counters
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return _data != nullptr; }
+
+    QString fileName() const { return _file.fileName(); }
+    quint32 size() const { return _size; }
+    quint64 timestamp() const { return _ts_file; } // [ms since epoch]
+    quint32 duration() const { return _ts_max; }   // [ms]
+    const QStringList &tags() const { return _tags; }
+    const QStringList &fields() const { return _fields; }
+
+    // counters collected while indexing
+    quint64 valuesCount() const { return _values_cnt; }
+    quint64 eventsCount() const { return _events_cnt; }
+    const QVector<quint32> &fieldCounts() const { return _field_cnt; } // values per field
+
+    // cursor
+    bool seek(quint32 ts);
+    bool next(record_s *rec, bool skip_values = false);
+    quint32 pos_ts() const { return _cur.ts; }
+
+    // fields values state at time [vidx], NaN when not received yet
+    QVector<double> values_at(quint32 ts);
+
+    // all events and messages up to time
+    QList<record_s> events_until(quint32 ts);
+
+private:
+    QFile _file;
+    const uchar *_data{};
+    quint32 _size{};
+    quint32 _data_offset{};
+
+    quint64 _ts_file{};
+    quint32 _ts_max{};
+    QStringList _tags;
+    QStringList _fields;
+
+    quint64 _values_cnt{};
+    quint64 _events_cnt{};
+    QVector<quint32> _field_cnt;
+
+    // decoder state
+    struct cursor_s
+    {
+        quint32 pos;
+        quint32 ts;
+        int vidx;
+    };
+    cursor_s _cur{};
+
+    // sparse seek index
+    struct index_s
+    {
+        quint32 ts; // time of the first record after cursor
+        cursor_s cur;
+        int snapshot; // index of values snapshot taken at this point or -1
+    };
+    QVector<index_s> _index;
+    QVector<QVector<double>> _snapshots;
+    QVector<quint32> _events; // events records offsets
+
+    // stream verification while indexing
+    bool _indexing{};
+    quint32 _crc{};
+    quint32 _crc_pos{};
+
+    bool build_index();
+    int index_lookup(quint32 ts) const;
+
+    // decode next record at cursor, returns false on stream end or error
+    bool decode(cursor_s &cur, record_s *rec, bool skip_values);
+    bool read_value(quint32 &pos, uint8_t dspec, double *v, bool *null);
+    bool read_string(quint32 &pos, QString *s);
+};
@@ -21,20 +21,32 @@
  */
 #include "TelemetryReqRead.h"
 #include "Database.h"
+#include "TelemetryFileReader.h"
+
+#include <App/AppDirs.h>
+
 #define MAX_CACHE_RECORDS 25000000
+// cache rows inserted per batch when made of binary file
+#define CACHE_FILE_BATCH 10000
+
+static QString recordFileName(const QString &s)
+{
+    if (s.isEmpty())
+        return QString();
+    QString fileName = AppDirs::telemetry().absoluteFilePath(s);
+    return QFile::exists(fileName) ? fileName : QString();
+}
 
 bool DBReqTelemetryFindCache::run(QSqlQuery &query)
 {
-    //check for invalid cache (telemetry hash is null)
-    query.prepare("SELECT * FROM Telemetry WHERE key=?");
+    //check for deleted record
+    // null hash marks stats only, the cache is kept up to date by write requests
+    query.prepare("SELECT file FROM Telemetry WHERE key=?");
     query.addBindValue(telemetryID);
     if (!query.exec())
         return false;
-    bool invalid;
-    if (query.next())
-        invalid = query.value("hash").toString().isEmpty();
-    else
-        invalid = true;
+    bool invalid = !query.next();
+    fileName = invalid ? QString() : recordFileName(query.value(0).toString());
 
     //check db invalid cache list
     if (!invalid) {
@@ -45,12 +57,15 @@ bool DBReqTelemetryFindCache::run(QSqlQuery &query)
 
     //find existing cache record
     if (!invalid) {
-        query.prepare("SELECT * FROM TelemetryCache WHERE telemetryID=?");
+        query.prepare("SELECT key,size FROM TelemetryCache WHERE telemetryID=?");
         query.addBindValue(telemetryID);
         if (!query.exec())
             return false;
         if (query.next()) {
             cacheID = query.value(0).toULongLong();
+            // binary file cache is valid for the file size it was made of
+            if (!fileName.isEmpty() && query.value(1).toLongLong() != QFileInfo(fileName).size())
+                cacheID = 0;
         }
     }
     if (!cacheID) {
@@ -70,6 +85,23 @@ bool DBReqTelemetryFindCache::run(QSqlQuery &query)
     return true;
 }
 
+bool DBReqTelemetryFindFile::run(QSqlQuery &query)
+{
+    query.prepare("SELECT file FROM Telemetry WHERE key=?");
+    query.addBindValue(telemetryID);
+    if (!query.exec())
+        return false;
+    if (query.next())
+        fileName = recordFileName(query.value(0).toString());
+    if (discarded())
+        return true;
+    if (fileName.isEmpty())
+        emit fileNotFound(telemetryID);
+    else
+        emit fileFound(telemetryID, fileName);
+    return true;
+}
+
 bool DBReqTelemetryMakeCache::run(QSqlQuery &query)
 {
     QElapsedTimer t0;
@@ -114,16 +146,19 @@ bool DBReqTelemetryMakeCache::run(QSqlQuery &query)
         quint64 count = query.value(0).toULongLong();
         if (count < MAX_CACHE_RECORDS)
             break;
-        query.prepare("SELECT key,MIN(time) FROM TelemetryCache");
+        query.prepare("SELECT key,telemetryID,MIN(time) FROM TelemetryCache");
         if (!query.exec())
             return false;
         if (!query.next())
             return false;
         quint64 key = query.value(0).toULongLong();
+        quint64 evictedID = query.value(1).toULongLong();
         query.prepare("DELETE FROM TelemetryCache WHERE key=?");
         query.addBindValue(key);
         if (!query.exec())
             return false;
+        //columnar cache file of the evicted record
+        TelemetryDB::cacheDir().remove(QString::number(evictedID));
         qDebug() << "removed" << key;
     }
 
@@ -132,6 +167,11 @@ bool DBReqTelemetryMakeCache::run(QSqlQuery &query)
         return false;
     bool bCommit = false;
     while (1) {
+        // one cache record per telemetry record
+        query.prepare("DELETE FROM TelemetryCache WHERE telemetryID=?");
+        query.addBindValue(telemetryID);
+        if (!query.exec())
+            return false;
         query.prepare("INSERT INTO TelemetryCache(telemetryID,time) VALUES(?,?)");
         query.addBindValue(telemetryID);
         query.addBindValue(t);
@@ -141,6 +181,14 @@ bool DBReqTelemetryMakeCache::run(QSqlQuery &query)
             break;
         cacheID = query.lastInsertId().toULongLong();
         //fill data
+        if (!fileName.isEmpty()) {
+            if (!fillFromFile(query))
+                return false;
+            if (discarded())
+                break;
+            bCommit = true;
+            break;
+        }
         query.prepare("DROP TABLE IF EXISTS tmp");
         if (!query.exec())
             return false;
@@ -202,6 +250,86 @@ bool DBReqTelemetryMakeCache::run(QSqlQuery &query)
     return true;
 }
 
+bool DBReqTelemetryMakeCache::fillFromFile(QSqlQuery &query)
+{
+    // same rows as made of the database tables, field names are mapped to keys
+    const qint64 size = QFileInfo(fileName).size();
+    TelemetryFileReader file;
+    if (!file.open(fileName))
+        return false;
+    auto d = static_cast<TelemetryDB *>(db);
+    QVector<quint64> fids;
+    for (auto const &name : file.fields())
+        fids.append(d->field_key(name));
+
+    QVariantList vCacheID, vTime, vType, vName, vValue, vUid;
+    quint64 records = 0;
+    auto flush = [&]() {
+        if (vTime.isEmpty())
+            return true;
+        query.prepare("INSERT INTO TelemetryCacheData"
+                      " (cacheID,time,type,name,value,uid)"
+                      " VALUES(?,?,?,?,?,?)");
+        query.addBindValue(vCacheID);
+        query.addBindValue(vTime);
+        query.addBindValue(vType);
+        query.addBindValue(vName);
+        query.addBindValue(vValue);
+        query.addBindValue(vUid);
+        if (!query.execBatch())
+            return false;
+        records += static_cast<quint64>(vTime.size());
+        vCacheID.clear();
+        vTime.clear();
+        vType.clear();
+        vName.clear();
+        vValue.clear();
+        vUid.clear();
+        return true;
+    };
+
+    TelemetryFileReader::record_s rec{};
+    while (file.next(&rec)) {
+        switch (rec.type) {
+        default:
+            continue;
+        case TelemetryFileReader::rec_e::value:
+        case TelemetryFileReader::rec_e::uplink: {
+            quint64 fid = fids.value(static_cast<int>(rec.vidx));
+            if (!fid)
+                continue;
+            vType.append(rec.type == TelemetryFileReader::rec_e::uplink ? 1 : QVariant());
+            vName.append(fid);
+            vValue.append(rec.null ? QVariant() : QVariant(rec.value));
+            vUid.append(QVariant());
+        } break;
+        case TelemetryFileReader::rec_e::evt:
+        case TelemetryFileReader::rec_e::msg:
+            vType.append(rec.uplink ? 3 : 2);
+            vName.append(rec.name);
+            vValue.append(rec.text);
+            vUid.append(rec.uid);
+            break;
+        }
+        vCacheID.append(cacheID);
+        vTime.append(rec.ts);
+        if (vTime.size() < CACHE_FILE_BATCH)
+            continue;
+        if (!flush())
+            return false;
+        if (discarded())
+            return true;
+    }
+    if (!flush())
+        return false;
+
+    query.prepare("UPDATE TelemetryCache SET records=?,size=? WHERE key=?");
+    query.addBindValue(records);
+    query.addBindValue(size);
+    query.addBindValue(cacheID);
+    return query.exec();
+}
+
 bool DBReqTelemetryMakeStats::run(QSqlQuery &query)
 {
     QElapsedTimer t0;
@@ -220,10 +348,15 @@ bool DBReqTelemetryMakeStats::run(QSqlQuery &query)
         return false;
     if (discarded())
         return true;
-    if (!stats.value("hash").toString().isEmpty()) {
+    const bool valid = !stats.value("hash").toString().isEmpty();
+
+    //create cache if missing, existing cache is kept up to date by write requests
+    if (!DBReqTelemetryMakeCache::run(query))
+        return false;
+
+    // binary file cache is remade when the file changed, so are the stats
+    if (valid && !(newCacheID && !fileName.isEmpty())) {
         //stats exists and valid
-        if (!DBReqTelemetryMakeCache::run(query))
-            return false;
         emit statsFound(telemetryID, stats);
         return true;
     }
@@ -231,11 +364,6 @@ bool DBReqTelemetryMakeStats::run(QSqlQuery &query)
     //collect data and update stats record
     if (discarded())
         return true;
-
-    //create cache
-    forceUpdate = true;
-    if (!DBReqTelemetryMakeCache::run(query))
-        return false;
     if (!cacheID) {
         qWarning() << "missing cache";
         return true;
@@ -36,6 +36,7 @@ public:
     {}
     //result
     quint64 cacheID;
+    QString fileName; // binary data file of the record
 
 protected:
     quint64 telemetryID;
@@ -46,6 +47,28 @@ signals:
     void cacheNotFound(quint64 telemetryID);
 };
 
+// check if record data is available in binary file
+class DBReqTelemetryFindFile : public DBReqTelemetry
+{
+    Q_OBJECT
+public:
+    explicit DBReqTelemetryFindFile(quint64 telemetryID)
+        : DBReqTelemetry()
+        , telemetryID(telemetryID)
+    {
+        readOnly = true;
+    }
+    //result
+    QString fileName;
+
+protected:
+    quint64 telemetryID;
+    bool run(QSqlQuery &query);
+signals:
+    void fileFound(quint64 telemetryID, QString fileName);
+    void fileNotFound(quint64 telemetryID);
+};
+
 class DBReqTelemetryMakeCache : public DBReqTelemetryFindCache
 {
     Q_OBJECT
@@ -54,13 +77,18 @@ public:
         : DBReqTelemetryFindCache(telemetryID)
         , newCacheID(0)
         , forceUpdate(forceUpdate)
-    {}
+    {
+        priority = Bulk;
+    }
     //result
     quint64 newCacheID;
 
 protected:
     bool forceUpdate;
     bool run(QSqlQuery &query);
+
+private:
+    bool fillFromFile(QSqlQuery &query);
 };
 
 class DBReqTelemetryMakeStats : public DBReqTelemetryMakeCache
@@ -69,7 +97,9 @@ class DBReqTelemetryMakeStats : public DBReqTelemetryMakeCache
 public:
     explicit DBReqTelemetryMakeStats(quint64 telemetryID)
         : DBReqTelemetryMakeCache(telemetryID, false)
-    {}
+    {
+        priority = Interactive; // opened by user
+    }
     //result
     QVariantMap stats;
 
@@ -88,7 +118,9 @@ public:
         : DBReqTelemetry()
         , cacheID(0)
         , telemetryID(telemetryID)
-    {}
+    {
+        readOnly = true;
+    }
     //result
     quint64 cacheID;
     QVariantMap info;
@@ -116,7 +148,9 @@ public:
         : DBReqTelemetry()
         , cacheID(cacheID)
         , time(time)
-    {}
+    {
+        readOnly = true;
+    }
 
 protected:
     bool run(QSqlQuery &query);
@@ -138,7 +172,9 @@ public:
         , cacheID(cacheID)
         , time(time)
         , name(name)
-    {}
+    {
+        readOnly = true;
+    }
 
 protected:
     bool run(QSqlQuery &query);
@@ -160,7 +196,9 @@ public:
         : DBReqTelemetry()
         , cacheID(cacheID)
         , time(time)
-    {}
+    {
+        readOnly = true;
+    }
 
 protected:
     bool run(QSqlQuery &query);
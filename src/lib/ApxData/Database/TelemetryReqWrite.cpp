@@ -44,6 +44,49 @@ bool DBReqTelemetryNewRecord::run(QSqlQuery &query)
     return true;
 }
 
+bool DBReqTelemetryWriteBase::updateCache(QSqlQuery &query, const cache_rows_s &rows)
+{
+    if (rows.time.isEmpty())
+        return true;
+
+    // stats must be updated on next read, the cache stays valid
+    query.prepare("UPDATE Telemetry SET hash=NULL WHERE key=? AND hash IS NOT NULL");
+    query.addBindValue(telemetryID);
+    if (!query.exec())
+        return false;
+
+    query.prepare("SELECT key FROM TelemetryCache WHERE telemetryID=?");
+    query.addBindValue(telemetryID);
+    if (!query.exec())
+        return false;
+    if (!query.next())
+        return true; // no cache yet
+    const quint64 cacheID = query.value(0).toULongLong();
+
+    QVariantList vCacheID;
+    for (int i = 0; i < rows.time.size(); ++i)
+        vCacheID.append(cacheID);
+
+    query.prepare("INSERT INTO TelemetryCacheData"
+                  " (cacheID,time,type,name,value,uid)"
+                  " VALUES(?,?,?,?,?,?)");
+    query.addBindValue(vCacheID);
+    query.addBindValue(rows.time);
+    query.addBindValue(rows.type);
+    query.addBindValue(rows.name);
+    query.addBindValue(rows.value);
+    query.addBindValue(rows.uid);
+    if (!query.execBatch())
+        return false;
+
+    query.prepare("UPDATE TelemetryCache SET records=records+? WHERE key=?");
+    query.addBindValue(rows.time.size());
+    query.addBindValue(cacheID);
+    if (!query.exec())
+        return false;
+    return true;
+}
+
 bool DBReqTelemetryWriteData::run(QSqlQuery &query)
 {
     // qDebug() << telemetryID << t << _values;
@@ -55,32 +98,111 @@ bool DBReqTelemetryWriteData::run(QSqlQuery &query)
 
     auto d = static_cast<TelemetryDB *>(db);
 
-    for (auto uid : _values.keys()) {
-        auto fkey = d->field_key(uid);
+    if (uplink) {
+        query.prepare("INSERT INTO TelemetryUplink"
+                      "(telemetryID, fieldID, time, value) "
+                      "VALUES(?, ?, ?, ?)");
+    } else {
+        query.prepare("INSERT INTO TelemetryDownlink"
+                      "(telemetryID, fieldID, time, value) "
+                      "VALUES(?, ?, ?, ?)");
+    }
+    cache_rows_s cache;
+    for (auto const &v : _values) {
+        auto fkey = d->field_key(v.uid);
         if (!fkey) {
-            qWarning() << "missing mandala uid" << uid;
+            qWarning() << "missing mandala uid" << v.uid;
             continue;
         }
-        auto value = _values.value(uid);
-
-        if (uplink) {
-            query.prepare("INSERT INTO TelemetryUplink"
-                          "(telemetryID, fieldID, time, value) "
-                          "VALUES(?, ?, ?, ?)");
-        } else {
-            query.prepare("INSERT INTO TelemetryDownlink"
-                          "(telemetryID, fieldID, time, value) "
-                          "VALUES(?, ?, ?, ?)");
-        }
-        query.addBindValue(telemetryID);
-        query.addBindValue(fkey);
-        query.addBindValue(t);
-        query.addBindValue(value);
+        auto value = v.toVariant();
+        query.bindValue(0, telemetryID);
+        query.bindValue(1, fkey);
+        query.bindValue(2, t);
+        query.bindValue(3, value);
         if (!query.exec()) {
             qWarning() << telemetryID << fkey;
             return false;
         }
+        cache.time.append(t);
+        cache.type.append(uplink ? 1 : QVariant());
+        cache.name.append(fkey);
+        cache.value.append(value);
+        cache.uid.append(QVariant());
+    }
+    rowsCount = _values.size();
+    return updateCache(query, cache);
+}
+
+void DBReqTelemetryWriteBatch::append(quint64 t, const PBase::Values &values, bool uplink)
+{
+    QVector<row_s> &rows = uplink ? _uplink : _downlink;
+    for (auto const &v : values)
+        rows.append({t, v.uid, v.toVariant()});
+}
+
+bool DBReqTelemetryWriteBatch::run(QSqlQuery &query)
+{
+    if (!telemetryID) {
+        qWarning() << "missing telemetryID";
+        return false;
+    }
+    cache_rows_s cache;
+    if (!insert(query, "TelemetryDownlink", _downlink, &cache, QVariant()))
+        return false;
+    if (!insert(query, "TelemetryUplink", _uplink, &cache, 1))
+        return false;
+    rowsCount = size();
+    return updateCache(query, cache);
+}
+
+bool DBReqTelemetryWriteBatch::insert(QSqlQuery &query,
+                                      const QString &table,
+                                      const QVector<row_s> &rows,
+                                      cache_rows_s *cache,
+                                      const QVariant &type)
+{
+    if (rows.isEmpty())
+        return true;
+
+    auto d = static_cast<TelemetryDB *>(db);
+
+    QVariantList vID, vField, vTime, vValue;
+    vID.reserve(rows.size());
+    vField.reserve(rows.size());
+    vTime.reserve(rows.size());
+    vValue.reserve(rows.size());
+
+    for (auto const &r : rows) {
+        auto fkey = d->field_key(r.uid);
+        if (!fkey) {
+            qWarning() << "missing mandala uid" << r.uid;
+            continue;
+        }
+        vID.append(telemetryID);
+        vField.append(fkey);
+        vTime.append(r.t);
+        vValue.append(r.value);
+        cache->type.append(type);
+        cache->uid.append(QVariant());
     }
+    if (vID.isEmpty())
+        return true;
+
+    query.prepare(QString("INSERT INTO %1"
+                          "(telemetryID, fieldID, time, value) "
+                          "VALUES(?, ?, ?, ?)")
+                      .arg(table));
+    query.addBindValue(vID);
+    query.addBindValue(vField);
+    query.addBindValue(vTime);
+    query.addBindValue(vValue);
+    if (!query.execBatch()) {
+        qWarning() << telemetryID << table << vID.size();
+        return false;
+    }
+    cache->time.append(vTime);
+    cache->name.append(vField);
+    cache->value.append(vValue);
     return true;
 }
 
@@ -98,7 +220,14 @@ bool DBReqTelemetryWriteEvent::run(QSqlQuery &query)
     query.addBindValue(uplink ? 1 : QVariant());
     if (!query.exec())
         return false;
-    return true;
+
+    cache_rows_s cache;
+    cache.time.append(t);
+    cache.type.append(uplink ? 3 : 2);
+    cache.name.append(name);
+    cache.value.append(value);
+    cache.uid.append(uid);
+    return updateCache(query, cache);
 }
 
 bool DBReqTelemetryWriteInfo::run(QSqlQuery &query)
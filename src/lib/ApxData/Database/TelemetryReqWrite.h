@@ -63,12 +63,25 @@ public:
         , telemetryID(telemetryID)
         , t(t)
         , uplink(uplink)
-    {}
+    {
+        priority = Ingest;
+    }
     quint64 telemetryID;
     quint64 t;
 
 protected:
     bool uplink;
+
+    // rows to append to existing records cache
+    struct cache_rows_s
+    {
+        QVariantList time;
+        QVariantList type;
+        QVariantList name;
+        QVariantList value;
+        QVariantList uid;
+    };
+    bool updateCache(QSqlQuery &query, const cache_rows_s &rows);
 };
 
 class DBReqTelemetryWriteData : public DBReqTelemetryWriteBase
@@ -90,6 +103,38 @@ protected:
     bool run(QSqlQuery &query);
 };
 
+// coalesced data frames, inserted with one prepared statement per table
+class DBReqTelemetryWriteBatch : public DBReqTelemetryWriteBase
+{
+    Q_OBJECT
+public:
+    explicit DBReqTelemetryWriteBatch(quint64 telemetryID)
+        : DBReqTelemetryWriteBase(telemetryID, 0, false)
+    {}
+
+    void append(quint64 t, const PBase::Values &values, bool uplink);
+    int size() const { return _downlink.size() + _uplink.size(); }
+
+private:
+    struct row_s
+    {
+        quint64 t;
+        mandala::uid_t uid;
+        QVariant value;
+    };
+    QVector<row_s> _downlink;
+    QVector<row_s> _uplink;
+
+    bool insert(QSqlQuery &query,
+                const QString &table,
+                const QVector<row_s> &rows,
+                cache_rows_s *cache,
+                const QVariant &type);
+
+protected:
+    bool run(QSqlQuery &query);
+};
+
 class DBReqTelemetryWriteEvent : public DBReqTelemetryWriteBase
 {
     Q_OBJECT
@@ -21,11 +21,14 @@
  */
 #include "VehiclesDB.h"
 #include "Database.h"
+#include "NodeDictCache.h"
 #include <App/AppDirs.h>
 
 VehiclesDB::VehiclesDB(QObject *parent, QString sessionName)
     : DatabaseSession(parent, "vehicles", sessionName, "1")
 {
+    dictCache = new NodeDictCache(this, AppDirs::db().absoluteFilePath("vehicles-dicts.cache"));
+
     new DBReqMakeTable(this,
                        "Nodes",
                        QStringList() << "key INTEGER PRIMARY KEY NOT NULL"
@@ -23,11 +23,15 @@
 
 #include "DatabaseSession.h"
 
+class NodeDictCache;
+
 class VehiclesDB : public DatabaseSession
 {
     Q_OBJECT
 public:
     explicit VehiclesDB(QObject *parent, QString sessionName);
+
+    NodeDictCache *dictCache;
 };
 
 class DBReqVehicles : public DatabaseRequest
@@ -20,6 +20,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "VehiclesReqNode.h"
+#include "Database.h"
+#include "NodeDictCache.h"
 
 bool DBReqNode::run(QSqlQuery &query)
 {
@@ -166,6 +168,8 @@ bool DBReqSaveNodeDict::run(QSqlQuery &query)
     if (!nodeID)
         return false;
 
+    Database::instance()->vehicles->dictCache->insert(_dict);
+
     auto hash = _dict.value("hash").toString();
 
     auto time = _dict.value("time").toULongLong();
@@ -345,6 +349,8 @@ bool DBReqLoadNodeDict::run(QSqlQuery &query)
     _dict.insert("time", time);
     _dict.insert("cached", true);
 
+    Database::instance()->vehicles->dictCache->insert(_dict);
+
     emit dictLoaded(_dict);
     return true;
 }
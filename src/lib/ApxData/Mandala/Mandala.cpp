@@ -47,6 +47,15 @@ Mandala::Mandala(Fact *parent)
 
     connect(this, &Mandala::sendValue, this, &Mandala::recordSendValue);
 
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(FLUSH_INTERVAL);
+    connect(&_flushTimer, &QTimer::timeout, this, &Mandala::flush);
+
+    _sendTimer.setSingleShot(true);
+    _sendTimer.setTimerType(Qt::PreciseTimer);
+    _sendTimer.setInterval(SEND_TICK);
+    connect(&_sendTimer, &QTimer::timeout, this, &Mandala::sendQueued);
+
     Fact *group = this;
     uint8_t level = 0;
     QString sect;
@@ -66,7 +75,7 @@ Mandala::Mandala(Fact *parent)
                 apxMsgW() << "dup group:" << group->child(d.name)->path(1);
             }
             MandalaFact *f = new MandalaFact(this, group, d);
-            _uid_map.insert(f->uid(), f);
+            insertFact(f);
             group = f;
             if (d.level == 2)
                 group->setSection(sect);
@@ -76,17 +85,26 @@ Mandala::Mandala(Fact *parent)
             apxMsgW() << "dup fact:" << group->child(d.name)->path(2);
         }
         MandalaFact *f = new MandalaFact(this, group, d);
-        _uid_map.insert(f->uid(), f);
+        insertFact(f);
     }
 
     // fill value facts list
-    for (auto f : _uid_map.values()) {
-        if (f->isSystem() || f->isGroup())
+    for (auto f : _facts) {
+        if (!f || f->isSystem() || f->isGroup())
             continue;
         _valueFacts.append(f);
     }
 
     _total = _valueFacts.size();
+
+    _sendClock.start();
+    _sendTime.fill(-SEND_INTERVAL, _facts.size());
+    _sendPending.resize(_facts.size());
+    _sendControl.resize(_facts.size());
+    for (auto f : _valueFacts) {
+        if (f->mpath().startsWith("cmd.rc."))
+            _sendControl.setBit(f->offset());
+    }
 }
 
 void Mandala::updateUsed(int adj)
@@ -95,6 +113,76 @@ void Mandala::updateUsed(int adj)
     updateStatus();
 }
 
+void Mandala::scheduleFlush(MandalaFact *f)
+{
+    _dirty.append(f);
+    if (!_flushTimer.isActive())
+        _flushTimer.start();
+}
+
+void Mandala::flush()
+{
+    // facts may be marked again while notified
+    QVector<MandalaFact *> list;
+    list.swap(_dirty);
+    for (auto f : list)
+        f->flush();
+}
+
+void Mandala::scheduleSend(MandalaFact *f)
+{
+    auto i = f->offset();
+    if (_sendPending.testBit(i))
+        return;
+    if (_sendClock.elapsed() - _sendTime.at(i) >= SEND_INTERVAL) {
+        f->send();
+        return;
+    }
+    _sendPending.setBit(i);
+    if (_sendControl.testBit(i))
+        _sendControls.append(f);
+    else
+        _sendQueue.append(f);
+    if (!_sendTimer.isActive())
+        _sendTimer.start();
+}
+
+void Mandala::updateSendTime(MandalaFact *f)
+{
+    _sendTime[f->offset()] = _sendClock.elapsed();
+}
+
+void Mandala::sendQueued()
+{
+    qint64 t = _sendClock.elapsed();
+    auto due = [this, t](MandalaFact *f) {
+        return t - _sendTime.at(f->offset()) >= SEND_INTERVAL;
+    };
+
+    // control channels go first and are released together on the same tick
+    if (std::any_of(_sendControls.begin(), _sendControls.end(), due)) {
+        QVector<MandalaFact *> list;
+        list.swap(_sendControls);
+        for (auto f : list) {
+            _sendPending.clearBit(f->offset());
+            f->send();
+        }
+    }
+
+    for (int i = 0; i < _sendQueue.size();) {
+        auto f = _sendQueue.at(i);
+        if (!due(f)) {
+            ++i;
+            continue;
+        }
+        _sendQueue.remove(i);
+        _sendPending.clearBit(f->offset());
+        f->send();
+    }
+    if (!(_sendQueue.isEmpty() && _sendControls.isEmpty()))
+        _sendTimer.start();
+}
+
 void Mandala::updateStatus()
 {
     setValue(QString("%1/%2").arg(_used).arg(_total));
@@ -106,11 +194,28 @@ void Mandala::resetCounters()
         f->setModified(false);
 }
 
+void Mandala::insertFact(MandalaFact *f)
+{
+    // uids are dense offsets from uid_base
+    const int i = f->offset();
+    if (i >= _facts.size())
+        _facts.resize(i + 1);
+    _facts[i] = f;
+}
+
+MandalaFact *Mandala::factAt(mandala::uid_t uid) const
+{
+    if (uid < mandala::uid_base)
+        return nullptr;
+    const int i = uid - mandala::uid_base;
+    return i < _facts.size() ? _facts.at(i) : nullptr;
+}
+
 MandalaFact *Mandala::fact(mandala::uid_t uid) const
 {
     if (uid == 0xFFFF || mandala::is_bundle(uid))
         return nullptr;
-    MandalaFact *f = _uid_map.value(uid);
+    MandalaFact *f = factAt(uid);
     if (f)
         return f;
     apxMsgW() << "Mandala uid not found:" << uid;
@@ -123,7 +228,12 @@ MandalaFact *Mandala::fact(const QString &mpath, bool silent) const
     if (mpath.isEmpty())
         return f;
     if (mpath.contains('.')) {
-        f = static_cast<MandalaFact *>(findChild(mpath));
+        auto const &map = pathMap();
+        auto it = map.find(mpath);
+        if (it != map.end())
+            f = factAt(it.value()->uid);
+        if (!f)
+            f = static_cast<MandalaFact *>(findChild(mpath));
     }
     if (!f && !silent) {
         apxMsgW() << "Mandala fact not found:" << mpath;
@@ -131,13 +241,24 @@ MandalaFact *Mandala::fact(const QString &mpath, bool silent) const
     return f;
 }
 
+const QHash<QString, const mandala::meta_s *> &Mandala::pathMap() // static
+{
+    // built once from the generated meta array
+    static const QHash<QString, const mandala::meta_s *> map = []() {
+        QHash<QString, const mandala::meta_s *> m;
+        m.reserve(sizeof(mandala::meta) / sizeof(*mandala::meta));
+        for (auto const &d : mandala::meta)
+            m.insert(QString(d.path), &d);
+        return m;
+    }();
+    return map;
+}
+
 mandala::uid_t Mandala::uid(const QString &mpath) // static
 {
-    for (auto const &d : mandala::meta) {
-        if (d.path == mpath)
-            return d.uid;
-    }
-    return {};
+    auto const &map = pathMap();
+    auto it = map.find(mpath);
+    return it != map.end() ? it.value()->uid : mandala::uid_t{};
 }
 
 QString Mandala::mandalaToString(xbus::pid_raw_t pid_raw) const
@@ -145,7 +266,7 @@ QString Mandala::mandalaToString(xbus::pid_raw_t pid_raw) const
     xbus::pid_s pid(pid_raw);
     if (!pid.seq)
         return QString();
-    MandalaFact *f = _uid_map.value(pid.uid);
+    MandalaFact *f = factAt(pid.uid);
     return f ? f->mpath() : QString();
 }
 xbus::pid_raw_t Mandala::stringToMandala(const QString &s) const
@@ -161,23 +282,44 @@ xbus::pid_raw_t Mandala::stringToMandala(const QString &s) const
 
 const mandala::meta_s &Mandala::meta(mandala::uid_t uid) // static
 {
-    for (auto const &d : mandala::meta) {
-        if (d.uid == uid)
-            return d;
+    // direct index by uid offset, built once from the generated meta array
+    static const QVector<const mandala::meta_s *> table = []() {
+        QVector<const mandala::meta_s *> t;
+        for (auto const &d : mandala::meta) {
+            const int i = d.uid - mandala::uid_base;
+            if (i < 0)
+                continue;
+            if (i >= t.size())
+                t.resize(i + 1);
+            t[i] = &d;
+        }
+        return t;
+    }();
+    if (uid >= mandala::uid_base) {
+        const int i = uid - mandala::uid_base;
+        if (i < table.size() && table.at(i))
+            return *table.at(i);
     }
     return mandala::cmd::env::nmt::meta;
 }
 
-void Mandala::telemetryData(PBase::Values values, quint64 timestamp_ms)
+void Mandala::updateValues(const PBase::Values &values, PBase::Values *rec_values)
 {
-    PBase::Values rec_values;
-    for (auto const &uid : values.keys()) {
-        MandalaFact *f = fact(uid);
+    // values are sorted by uid, so are the converted values
+    rec_values->reserve(values.size());
+    for (auto const &v : values) {
+        MandalaFact *f = fact(v.uid);
         if (!f)
             continue;
-        f->setValueFromStream(values.value(uid));
-        rec_values.insert(uid, f->value());
+        f->setValueFromStream(v.toVariant());
+        rec_values->insert(v.uid, f->value());
     }
+}
+
+void Mandala::telemetryData(PBase::Values values, quint64 timestamp_ms)
+{
+    PBase::Values rec_values;
+    updateValues(values, &rec_values);
     emit recordTelemetry(rec_values, timestamp_ms);
     emit telemetryDecoded();
 }
@@ -185,13 +327,7 @@ void Mandala::telemetryData(PBase::Values values, quint64 timestamp_ms)
 void Mandala::valuesData(PBase::Values values)
 {
     PBase::Values rec_values;
-    for (auto const &uid : values.keys()) {
-        MandalaFact *f = fact(uid);
-        if (!f)
-            continue;
-        f->setValueFromStream(values.value(uid));
-        rec_values.insert(uid, f->value());
-    }
+    updateValues(values, &rec_values);
     emit recordData(rec_values, false);
 }
 
@@ -45,18 +45,50 @@ public:
 
     void updateUsed(int adj);
 
+    // conflated UI notifications of stream updates
+    void scheduleFlush(MandalaFact *f);
+    static constexpr int FLUSH_INTERVAL{33}; // [ms]
+
+    // uplink throttle shared by all facts
+    void scheduleSend(MandalaFact *f);
+    void updateSendTime(MandalaFact *f);
+    static constexpr int SEND_INTERVAL{100}; // [ms]
+    static constexpr int SEND_TICK{20};      // [ms]
+
 protected:
     // Fact override
     virtual QString mandalaToString(xbus::pid_raw_t pid_raw) const override;
     virtual xbus::pid_raw_t stringToMandala(const QString &s) const override;
 
 private:
-    QMap<mandala::uid_t, MandalaFact *> _uid_map;
+    // indexed by uid offset from mandala::uid_base
+    QVector<MandalaFact *> _facts;
     QList<MandalaFact *> _valueFacts;
 
+    void insertFact(MandalaFact *f);
+
+    MandalaFact *factAt(mandala::uid_t uid) const; // no warnings
+    static const QHash<QString, const mandala::meta_s *> &pathMap();
+
+    QVector<MandalaFact *> _dirty;
+    QTimer _flushTimer;
+    void flush();
+
+    // uplink throttle state, indexed by uid offset
+    QElapsedTimer _sendClock;
+    QVector<qint64> _sendTime; // last uplink [ms]
+    QBitArray _sendPending;
+    QBitArray _sendControl; // cmd.rc channels
+    QVector<MandalaFact *> _sendQueue;
+    QVector<MandalaFact *> _sendControls;
+    QTimer _sendTimer;
+    void sendQueued();
+
     uint _total{};
     uint _used{};
 
+    void updateValues(const PBase::Values &values, PBase::Values *rec_values);
+
 private slots:
     void recordSendValue(mandala::uid_t uid, QVariant value);
 
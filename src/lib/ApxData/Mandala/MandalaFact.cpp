@@ -110,11 +110,6 @@ MandalaFact::MandalaFact(Mandala *tree, Fact *parent, const mandala::meta_s &met
             }
 
             setOpt("color", getColor());
-
-            sendTime.start();
-            sendTimer.setInterval(100);
-            sendTimer.setSingleShot(true);
-            connect(&sendTimer, &QTimer::timeout, this, &MandalaFact::send);
         } else {
             setDataType(Int);
         }
@@ -138,19 +133,20 @@ bool MandalaFact::setValue(const QVariant &v)
     bool rv = Fact::setValue(v);
 
     // qDebug() << name() << text() << rv;
-    if (sendTimer.isActive())
-        return rv;
-    if (sendTime.elapsed() >= sendTimer.interval())
-        send();
-    else
-        sendTimer.start();
+    m_tree->scheduleSend(this);
     return rv;
 }
 
 void MandalaFact::setValueFromStream(const QVariant &v)
 {
     //qDebug() << v;
-    setRawValueLocal(convertFromStream(v));
+    // value is updated immediately for recorders, valueChanged is conflated
+    QVariant vx = convertFromStream(v);
+    if (m_value != vx) {
+        m_value.swap(vx);
+        _dirtyValue = true;
+        emit streamValueChanged();
+    }
     increment_rx_cnt();
 }
 QVariant MandalaFact::convertFromStream(const QVariant &v) const
@@ -183,14 +179,43 @@ bool MandalaFact::setRawValueLocal(QVariant v)
     return true;
 }
 
+bool MandalaFact::setValueQuiet(const QVariant &v)
+{
+    if (!updateValue(v))
+        return false;
+    _dirtyValue = true;
+    m_tree->scheduleSend(this);
+    return true;
+}
+
 void MandalaFact::increment_rx_cnt()
 {
     _rx_cnt++;
     _everReceived = true;
-    if (isSystem()) {
-        Fact::setValue(QVariant::fromValue(_rx_cnt));
-    } else {
-        setModified(true);
+    _dirtyCnt = true;
+    markDirty();
+}
+void MandalaFact::markDirty()
+{
+    if (_dirty)
+        return;
+    _dirty = true;
+    m_tree->scheduleFlush(this);
+}
+void MandalaFact::flush()
+{
+    _dirty = false;
+    if (_dirtyValue) {
+        _dirtyValue = false;
+        emit valueChanged();
+    }
+    if (_dirtyCnt) {
+        _dirtyCnt = false;
+        if (isSystem()) {
+            Fact::setValue(QVariant::fromValue(_rx_cnt));
+        } else {
+            setModified(true);
+        }
     }
 }
 void MandalaFact::updateCounters()
@@ -220,7 +245,7 @@ void MandalaFact::send()
 }
 void MandalaFact::sendValue(QVariant v)
 {
-    sendTime.start();
+    m_tree->updateSendTime(this);
     m_tree->sendValue(uid(), convertForStream(v));
 }
 
@@ -48,12 +48,18 @@ public:
 
     Q_INVOKABLE mandala::uid_t offset() const;
 
-    // units conversions
+    // units conversions, UI is notified on next Mandala flush
     void setValueFromStream(const QVariant &v);
 
     bool setRawValueLocal(QVariant v);
 
+    // value is stored without notification, UI is updated by the next flush() call
+    bool setValueQuiet(const QVariant &v);
+
     void increment_rx_cnt();
+
+    // emit pending notifications, called by Mandala
+    void flush();
     auto rx_cnt() const { return _rx_cnt; }
     auto everReceived() const { return _everReceived; }
 
@@ -77,9 +83,6 @@ private:
     qreal _conversion_factor{1.};
     bool _convert_gps{};
 
-    QElapsedTimer sendTime;
-    QTimer sendTimer;
-
     int getPrecision();
     QColor getColor();
 
@@ -87,6 +90,16 @@ private:
     bool _everReceived{};
     void updateCounters();
 
+    // pending UI notifications
+    bool _dirty{};
+    bool _dirtyValue{};
+    bool _dirtyCnt{};
+    void markDirty();
+
     QVariant convertFromStream(const QVariant &v) const;
     QVariant convertForStream(const QVariant &v) const;
+
+signals:
+    // every stream update of the value, valueChanged is conflated for UI
+    void streamValueChanged();
 };
@@ -27,6 +27,7 @@
 
 #include "PTrace.h"
 #include "PTreeBase.h"
+#include "PValues.h"
 
 class PVehicle;
 class PFirmware;
@@ -45,7 +46,7 @@ public:
 
     virtual void process_downlink(QByteArray packet) = 0;
 
-    typedef QHash<mandala::uid_t, QVariant> Values;
+    typedef PValues Values;
 
     // interface to node firmware loader
     PFirmware *firmware() const { return m_firmware; }
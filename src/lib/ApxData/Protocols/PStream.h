@@ -33,6 +33,9 @@ public:
         : XbusStreamReader(reinterpret_cast<const uint8_t *>(packet.data()),
                            static_cast<size_t>(packet.size()))
     {}
+    PStreamReader(const void *data, size_t size)
+        : XbusStreamReader(static_cast<const uint8_t *>(data), size)
+    {}
 
     inline QString dump_header() { return header().toHex().toUpper(); }
     inline QString dump_payload() { return payload().toHex().toUpper(); }
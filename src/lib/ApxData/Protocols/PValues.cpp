@@ -0,0 +1,173 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PValues.h"
+
+QVariant PValues::value_s::toVariant() const
+{
+    switch (type) {
+    case Null:
+        break;
+    case UInt:
+        if (raw.u > std::numeric_limits<uint>::max())
+            return QVariant::fromValue(raw.u);
+        return QVariant::fromValue(static_cast<uint>(raw.u));
+    case Real:
+        return QVariant::fromValue(raw.f);
+    case Double:
+        return QVariant::fromValue(raw.d);
+    }
+    return QVariant();
+}
+
+double PValues::value_s::toDouble() const
+{
+    switch (type) {
+    case Null:
+        break;
+    case UInt:
+        return static_cast<double>(raw.u);
+    case Real:
+        return static_cast<double>(raw.f);
+    case Double:
+        return raw.d;
+    }
+    return 0;
+}
+
+bool PValues::value_s::operator==(const value_s &other) const
+{
+    if (uid != other.uid || type != other.type)
+        return false;
+    switch (type) {
+    case Null:
+        return true;
+    case UInt:
+        return raw.u == other.raw.u;
+    case Real:
+        return raw.f == other.raw.f;
+    case Double:
+        return raw.d == other.raw.d;
+    }
+    return false;
+}
+
+PValues::value_s PValues::make(mandala::uid_t uid, quint64 v)
+{
+    value_s r{uid, UInt, {0}};
+    r.raw.u = v;
+    return r;
+}
+PValues::value_s PValues::make(mandala::uid_t uid, qint64 v)
+{
+    if (v >= 0)
+        return make(uid, static_cast<quint64>(v));
+    return make(uid, static_cast<double>(v));
+}
+PValues::value_s PValues::make(mandala::uid_t uid, float v)
+{
+    value_s r{uid, Real, {0}};
+    r.raw.f = v;
+    return r;
+}
+PValues::value_s PValues::make(mandala::uid_t uid, double v)
+{
+    value_s r{uid, Double, {0}};
+    r.raw.d = v;
+    return r;
+}
+
+PValues::value_s PValues::make(mandala::uid_t uid, const QVariant &v)
+{
+    if (v.isNull())
+        return {uid, Null, {0}};
+
+    switch (static_cast<QMetaType::Type>(v.type())) {
+    case QMetaType::Float:
+        return make(uid, v.toFloat());
+    case QMetaType::Bool:
+    case QMetaType::UChar:
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        return make(uid, static_cast<quint64>(v.toULongLong()));
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        return make(uid, static_cast<qint64>(v.toLongLong()));
+    default:
+        return make(uid, v.toDouble());
+    }
+}
+
+PValues::value_s *PValues::lowerBound(mandala::uid_t uid)
+{
+    return std::lower_bound(_values.begin(),
+                            _values.end(),
+                            uid,
+                            [](const value_s &v, mandala::uid_t uid) { return v.uid < uid; });
+}
+
+void PValues::insert(const value_s &v)
+{
+    // decoders mostly produce ascending uids
+    if (_values.isEmpty() || _values.last().uid < v.uid) {
+        _values.append(v);
+        return;
+    }
+    auto it = lowerBound(v.uid);
+    if (it != _values.end() && it->uid == v.uid) {
+        *it = v;
+        return;
+    }
+    _values.insert(it, v);
+}
+
+bool PValues::update(const value_s &v)
+{
+    auto it = lowerBound(v.uid);
+    if (it != _values.end() && it->uid == v.uid) {
+        if (*it == v)
+            return false;
+        *it = v;
+        return true;
+    }
+    _values.insert(it, v);
+    return true;
+}
+
+const PValues::value_s *PValues::find(mandala::uid_t uid) const
+{
+    auto it = const_cast<PValues *>(this)->lowerBound(uid);
+    if (it != _values.end() && it->uid == uid)
+        return it;
+    return nullptr;
+}
+
+QVariant PValues::value(mandala::uid_t uid) const
+{
+    auto v = find(uid);
+    return v ? v->toVariant() : QVariant();
+}
@@ -0,0 +1,114 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QtCore>
+
+#include <MandalaMetaTree.h>
+
+#include <type_traits>
+
+// Flat batch of typed mandala values sorted by uid.
+// Values are stored unboxed with inline storage for a typical telemetry frame.
+class PValues
+{
+public:
+    enum Type : quint8 {
+        Null, // request or no value
+        UInt,
+        Real, // float
+        Double,
+    };
+
+    struct value_s
+    {
+        mandala::uid_t uid;
+        Type type;
+        union {
+            quint64 u;
+            float f;
+            double d;
+        } raw;
+
+        QVariant toVariant() const;
+        double toDouble() const;
+
+        bool operator==(const value_s &other) const;
+        bool operator!=(const value_s &other) const { return !(*this == other); }
+    };
+
+    static value_s make(mandala::uid_t uid, const QVariant &v);
+
+    static value_s make(mandala::uid_t uid, quint64 v);
+    static value_s make(mandala::uid_t uid, qint64 v);
+    static value_s make(mandala::uid_t uid, float v);
+    static value_s make(mandala::uid_t uid, double v);
+    template<typename T>
+    static value_s make(mandala::uid_t uid, T v)
+    {
+        static_assert(std::is_integral<T>::value, "unsupported value type");
+        using I = typename std::conditional<std::is_signed<T>::value, qint64, quint64>::type;
+        return make(uid, static_cast<I>(v));
+    }
+
+    // replaces existing value of the same uid
+    void insert(const value_s &v);
+    void insert(mandala::uid_t uid, const QVariant &v) { insert(make(uid, v)); }
+    template<typename T>
+    void insert(mandala::uid_t uid, T v)
+    {
+        insert(make(uid, v));
+    }
+
+    // returns true when the value was added or changed
+    bool update(const value_s &v);
+
+    const value_s *find(mandala::uid_t uid) const;
+    QVariant value(mandala::uid_t uid) const;
+
+    template<typename F>
+    void removeIf(F f)
+    {
+        int n = 0;
+        for (int i = 0; i < _values.size(); ++i) {
+            if (f(_values.at(i)))
+                continue;
+            if (n != i)
+                _values[n] = _values.at(i);
+            n++;
+        }
+        _values.resize(n);
+    }
+
+    bool isEmpty() const { return _values.isEmpty(); }
+    int size() const { return _values.size(); }
+    void clear() { _values.clear(); }
+    void reserve(int size) { _values.reserve(size); }
+
+    const value_s *begin() const { return _values.cbegin(); }
+    const value_s *end() const { return _values.cend(); }
+
+private:
+    QVarLengthArray<value_s, 32> _values;
+
+    value_s *lowerBound(mandala::uid_t uid);
+};
@@ -50,6 +50,16 @@ Datalink::Datalink(Fact *parent)
                        "heart-circle-outline");
     f_hbeat->setDefaultValue(true);
 
+    qRegisterMetaType<DatalinkConnection::Packets>("DatalinkConnection::Packets");
+    qRegisterMetaType<DatalinkConnection::Frames>("DatalinkConnection::Frames");
+
+    engine = new DatalinkEngine(this);
+    connect(engine,
+            &DatalinkEngine::packetsAvailable,
+            this,
+            &Datalink::enginePacketsAvailable,
+            Qt::QueuedConnection);
+
     f_stats = new DatalinkStats(this);
 
     f_protocols = new Protocols(this);
@@ -87,13 +97,27 @@ Datalink::Datalink(Fact *parent)
 
     App::jsync(this);
 }
+Datalink::~Datalink()
+{
+    // return all devices to this thread before the engine stops
+    for (auto c : connections) {
+        if (!c)
+            continue;
+        c->close();
+        engine->removeConnection(c);
+        c->setEngine(nullptr);
+    }
+    delete engine;
+}
 
 void Datalink::addConnection(DatalinkConnection *c)
 {
     connections.append(c);
-    connect(c, &DatalinkConnection::packetReceived, this, &Datalink::connectionPacketReceived);
+    c->setEngine(engine);
+    engine->addConnection(c);
     connect(c, &Fact::removed, this, [this, c]() {
         //qDebug()<<"rm"<<c;
+        engine->removeConnection(c);
         connections.removeOne(c);
         updateStatus();
     });
@@ -146,27 +170,18 @@ void Datalink::hbeatChanged()
         heartbeatTimer.stop();
 }
 
-void Datalink::connectionPacketReceived(QByteArray packet, quint16 network)
+void Datalink::enginePacketsAvailable()
 {
-    //qDebug()<<"R"<<packet.toHex().toUpper();
-    if (packet.isEmpty())
-        return;
-    if (!network)
-        return;
-    DatalinkConnection *src = qobject_cast<DatalinkConnection *>(sender());
-    if (!src)
-        return;
-    for (int i = 0; i < connections.size(); ++i) {
-        DatalinkConnection *c = connections.at(i);
-        if (!c)
-            continue;
-        if (c == src)
-            continue;
-
-        c->sendPacket(packet, network);
+    // packets are already relayed to other connections by the engine
+    DatalinkConnection::Packets packets;
+    while (engine->readPackets(packets)) {
+        // views into the batch, receivers must copy the data to keep it
+        packets.forEach([this](const DatalinkConnection::PacketInfo &info, const QByteArray &view) {
+            //qDebug()<<"R"<<view.toHex().toUpper();
+            f_stats->countDownlink(info);
+            emit packetReceived(view);
+        });
     }
-
-    emit packetReceived(packet);
 }
 void Datalink::sendPacket(QByteArray packet)
 {
@@ -176,12 +191,7 @@ void Datalink::sendPacket(QByteArray packet)
     if (packet.isEmpty())
         return;
 
-    for (int i = 0; i < connections.size(); ++i) {
-        DatalinkConnection *c = connections.at(i);
-        if (!c)
-            continue;
-        c->sendPacket(packet, LOCAL);
-    }
+    engine->transmit(packet, LOCAL);
     emit packetTransmitted(packet);
 }
 
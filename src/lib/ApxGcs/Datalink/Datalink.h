@@ -22,6 +22,7 @@
 #pragma once
 
 #include "DatalinkConnection.h"
+#include "DatalinkEngine.h"
 #include "DatalinkPorts.h"
 #include "DatalinkRemotes.h"
 #include "DatalinkServer.h"
@@ -42,6 +43,7 @@ class Datalink : public Fact
 
 public:
     explicit Datalink(Fact *parent = nullptr);
+    ~Datalink() override;
 
     enum NetworkMask {
         LOCAL = 1,   //this GCS
@@ -63,6 +65,8 @@ public:
 
     DatalinkStats *f_stats;
 
+    DatalinkEngine *engine;
+
     void addConnection(DatalinkConnection *c);
     QList<QPointer<DatalinkConnection>> connections;
 
@@ -93,7 +97,7 @@ private slots:
 
     //internal connections
 private slots:
-    void connectionPacketReceived(QByteArray packet, quint16 network);
+    void enginePacketsAvailable();
 
     //external connections
 public slots:
@@ -21,6 +21,7 @@
  */
 #include "DatalinkConnection.h"
 #include "Datalink.h"
+#include "DatalinkEngine.h"
 #include <App/AppLog.h>
 
 #include <Mandala/Mandala.h>
@@ -30,6 +31,8 @@
 
 #include <Protocols/PStream.h>
 
+#include <typeinfo>
+
 DatalinkConnection::DatalinkConnection(Fact *parent,
                                        const QString &name,
                                        const QString &title,
@@ -54,6 +57,29 @@ DatalinkConnection::DatalinkConnection(Fact *parent,
     connect(this, &DatalinkConnection::urlChanged, this, &DatalinkConnection::updateTitle);
     connect(this, &DatalinkConnection::statusChanged, this, &DatalinkConnection::updateTitle);
     setUrl(title);
+
+    connect(this, &DatalinkConnection::activatedChanged, this, &DatalinkConnection::publishState);
+    connect(this, &Fact::activeChanged, this, &DatalinkConnection::publishState);
+    connect(this, &DatalinkConnection::rxNetworkChanged, this, &DatalinkConnection::publishState);
+    connect(this, &DatalinkConnection::txNetworkChanged, this, &DatalinkConnection::publishState);
+    connect(this,
+            &DatalinkConnection::blockControlsChanged,
+            this,
+            &DatalinkConnection::publishState);
+    connect(this,
+            &DatalinkConnection::blockServiceChanged,
+            this,
+            &DatalinkConnection::publishState);
+    publishState();
+}
+
+void DatalinkConnection::publishState()
+{
+    _io.enabled.store(activated() && active(), std::memory_order_release);
+    _io.rxNetwork.store(m_rxNetwork, std::memory_order_release);
+    _io.txNetwork.store(m_txNetwork, std::memory_order_release);
+    _io.blockControls.store(m_blockControls, std::memory_order_release);
+    _io.blockService.store(m_blockService, std::memory_order_release);
 }
 
 void DatalinkConnection::updateDescr()
@@ -74,6 +100,9 @@ void DatalinkConnection::updateDescr()
     QString s = QString("RX: %1 / TX: %2").arg(rx.join(',')).arg(tx.join(','));
     if (m_blockControls)
         s.append(" NOCTR");
+    const QString &sx = descrInfo();
+    if (!sx.isEmpty())
+        s.append(" ").append(sx);
     setDescr(s);
 }
 void DatalinkConnection::updateTitle()
@@ -96,86 +125,140 @@ void DatalinkConnection::setDecoder(SerialDecoder *decoder)
     _decoder = decoder;
     resetDataStream();
 }
+void DatalinkConnection::setEngine(DatalinkEngine *engine)
+{
+    _engine = engine;
+}
+void DatalinkConnection::detachDevice()
+{
+    if (_engine && _device)
+        _engine->detach(this);
+}
+void DatalinkConnection::scheduleRead()
+{
+    // posted events follow the device when it is moved between threads
+    QObject *ctx = _device ? static_cast<QObject *>(_device) : this;
+    QMetaObject::invokeMethod(ctx, [this]() { readDataAvailable(); }, Qt::QueuedConnection);
+}
+
 void DatalinkConnection::resetDataStream()
 {
     if (_decoder)
         _decoder->reset();
-    _rx_fifo.reset();
+    allocPackets();
 }
 
-void DatalinkConnection::sendPacket(QByteArray packet, quint16 network)
+bool DatalinkConnection::acceptsTx(quint16 network) const
 {
-    if (!(activated() && active()))
-        return;
-    if (!(m_txNetwork & network))
+    if (!_io.enabled.load(std::memory_order_acquire))
+        return false;
+    if (!(_io.txNetwork.load(std::memory_order_acquire) & network))
+        return false;
+    return _encoder;
+}
+size_t DatalinkConnection::framing() const
+{
+    return typeid(*_encoder).hash_code();
+}
+DatalinkConnection::Frames DatalinkConnection::encode(const Packets &packets)
+{
+    Frames frames;
+    frames.index.reserve(packets.count());
+    packets.forEach([this, &frames](const PacketInfo &info, const QByteArray &packet) {
+        auto cnt = _encoder->encode(packet.constData(), info.size);
+        if (cnt <= 0) {
+            apxConsoleW() << "TX encode:" << info.size << cnt;
+            return;
+        }
+        const bool keep = info.control || info.cls == PacketInfo::Nmt
+                          || mandala::cmd::env::nmt::match(info.inner);
+        // single mandala values and transponder state, other payloads are not superseded
+        const bool coalesce = info.inner && !keep
+                              && (!mandala::cmd::env::match(info.inner)
+                                  || info.inner == mandala::cmd::env::telemetry::xpdr::uid);
+        Frames::frame_s f{frames.data.size(),
+                          static_cast<int>(cnt),
+                          info.inner ? info.inner : info.uid,
+                          info.squawk,
+                          keep,
+                          coalesce};
+        frames.index.append(f);
+        frames.data.append((const char *) _encoder->data(), f.size);
+    });
+    return frames;
+}
+void DatalinkConnection::writeFrames(Frames frames)
+{
+    if (!_io.enabled.load(std::memory_order_acquire))
         return;
+    sendFrames(frames);
+
+    _traffic.txCnt.fetch_add(static_cast<quint64>(frames.count()), std::memory_order_relaxed);
+    _traffic.txData.fetch_add(static_cast<quint64>(frames.data.size()), std::memory_order_relaxed);
 
-    if (!_encoder) {
-        qDebug() << "TX no encoder";
+    // qDebug() << "TX" << frames.data.size();
+}
+void DatalinkConnection::sendFrames(const Frames &frames)
+{
+    write(frames.data);
+}
+
+void DatalinkConnection::allocPackets()
+{
+    if (!_rx_packets.isShared()) {
+        // released by all consumers, keep the reserved storage
+        _rx_packets.clear();
         return;
     }
-
-    auto cnt = _encoder->encode(packet.data(), static_cast<size_t>(packet.size()));
-    if (cnt <= 0) {
-        apxConsoleW() << "TX encode:" << packet.size() << cnt;
+    // last batch is still held by consumers, take released storage from the pool
+    for (auto &i : _rx_pool) {
+        if (i.isShared())
+            continue;
+        std::swap(i, _rx_packets);
+        _rx_packets.clear();
         return;
     }
-
-    write(QByteArray((const char *) _encoder->data(), cnt));
-
-    // qDebug() << "TX" << wcnt << cnt << packet.size()
-    //          << QString::number(apx::crc32(packet.data(), packet.size()), 16);
+    if (_rx_packets.data.capacity() > 0 && _rx_pool.size() < RXPOOL_SIZE)
+        _rx_pool.append(_rx_packets);
+    _rx_packets = Packets();
+    _rx_packets.data.reserve(RXBUF_SIZE);
 }
 
 void DatalinkConnection::readDataAvailable()
 {
+    // drain PHY, decoding all available frames into one batch
+    allocPackets();
+
     for (;;) {
-        QByteArray packet = _readPacket();
-        if (packet.isEmpty())
-            return;
+        auto data = read();
+        if (data.isEmpty())
+            break;
+        _traffic.rxData.fetch_add(static_cast<quint64>(data.size()), std::memory_order_relaxed);
+        decode(data);
+    }
 
-        // qDebug() << "DPRX" << packet.size();
+    if (_rx_packets.isEmpty())
+        return;
 
-        if (!(activated() && active()))
-            return;
+    _traffic.rxCnt.fetch_add(static_cast<quint64>(_rx_packets.count()), std::memory_order_relaxed);
 
-        bool ctr = isControlPacket(packet);
-        if (m_blockControls && ctr)
-            return;
-        if (m_blockService && (!ctr))
-            return;
+    // qDebug() << "DPRX" << _rx_packets.count();
 
-        emit packetReceived(packet, m_rxNetwork);
-    }
+    if (_io.enabled.load(std::memory_order_acquire))
+        emit packetsReceived(_rx_packets, _io.rxNetwork.load(std::memory_order_acquire));
+
+    // the batch is recycled by the next call, clearing it here would detach the shared storage
 }
-QByteArray DatalinkConnection::_readPacket()
+void DatalinkConnection::decode(const QByteArray &data)
 {
-    // first return already decoded packets
-    if (!_rx_fifo.empty()) {
-        // qDebug() << "RX FIFO" << _rx_fifo.used();
-        QTimer::singleShot(0, this, &DatalinkConnection::readDataAvailable);
-        return _rx_pkt.left(_rx_fifo.read_packet(_rx_pkt.data(), _rx_pkt.size()));
-    }
-
-    // read PHY and continue decoding
-    auto data = read();
-    if (data.size() <= 0) {
-        return {};
-    }
-
-    // schedule reads for next packet
-    QTimer::singleShot(0, this, &DatalinkConnection::readDataAvailable);
-
     if (!_decoder) {
         qDebug() << "RX no decoder";
-        return {};
+        return;
     }
 
-    // read bytes count (rcnt) might be more than one packet
-    // decode all packets from raw data into fifo
+    // read bytes count might be more than one packet
     const uint8_t *src = reinterpret_cast<const uint8_t *>(data.constData());
     size_t cnt = data.size();
-    bool pkt = false;
     while (cnt > 0) {
         // feed the decoder
         auto decoded_cnt = _decoder->decode(src, cnt);
@@ -189,14 +272,16 @@ QByteArray DatalinkConnection::_readPacket()
 
         // check if some pkt is available
         switch (_decoder->status()) {
-        case SerialDecoder::PacketAvailable:
-            pkt = true;
+        case SerialDecoder::PacketAvailable: {
             // qDebug() << "RX PKT" << _decoder->size();
-
-            if (!_rx_fifo.write_packet(_decoder->data(), _decoder->size())) {
-                qWarning() << "RX fifo full";
-            }
+            const PacketInfo info = packetInfo(_decoder->data(), _decoder->size());
+            if (info.control && _io.blockControls.load(std::memory_order_relaxed))
+                break;
+            if (!info.control && _io.blockService.load(std::memory_order_relaxed))
+                break;
+            _rx_packets.append(info, _decoder->data());
             break;
+        }
         case SerialDecoder::DataAccepted:
         case SerialDecoder::DataDropped:
             break;
@@ -205,11 +290,6 @@ QByteArray DatalinkConnection::_readPacket()
             break;
         }
     }
-
-    if (!pkt)
-        return {};
-
-    return _rx_pkt.left(_rx_fifo.read_packet(_rx_pkt.data(), _rx_pkt.size()));
 }
 
 void DatalinkConnection::opened()
@@ -219,33 +299,69 @@ void DatalinkConnection::opened()
         return;
     }
     setActive(true);
+    if (_engine && _device)
+        _engine->attach(this, _device);
 }
 void DatalinkConnection::closed()
 {
+    detachDevice();
     resetDataStream();
     setActive(false);
 }
 
-bool DatalinkConnection::isControlPacket(const QByteArray &packet) const
+DatalinkConnection::PacketInfo DatalinkConnection::packetInfo(const void *data, size_t size)
 {
-    PStreamReader stream(packet);
+    PacketInfo info;
+    info.size = static_cast<quint16>(size);
+
+    PStreamReader stream(data, size);
 
     if (stream.available() < xbus::pid_s::psize())
-        return true;
+        return info;
 
     xbus::pid_s pid;
     pid.read(&stream);
 
+    info.valid = true;
+    info.uid = pid.uid;
+    info.pri = pid.pri;
+
     auto uid = pid.uid;
 
-    if (mandala::cmd::env::nmt::match(uid))
-        return false;
-    if (mandala::cmd::env::vehicle::ident::match(uid))
-        return false;
-    if (mandala::cmd::env::vehicle::downlink::match(uid))
-        return false;
+    if (mandala::cmd::env::nmt::match(uid)) {
+        info.cls = PacketInfo::Nmt;
+        info.control = false;
+        return info;
+    }
+    if (!mandala::cmd::env::vehicle::match(uid))
+        return info;
+
+    info.cls = PacketInfo::Vehicle;
+    if (stream.available() >= sizeof(xbus::vehicle::squawk_t))
+        info.squawk = stream.read<xbus::vehicle::squawk_t>();
+
+    if (mandala::cmd::env::vehicle::ident::match(uid)) {
+        info.control = false;
+        return info;
+    }
+    if (mandala::cmd::env::vehicle::downlink::match(uid)) {
+        info.control = false;
+        if (stream.available() < 1)
+            return info;
+        uint8_t vuid_n;
+        stream >> vuid_n;
+    } else if (!mandala::cmd::env::vehicle::uplink::match(uid)) {
+        return info;
+    }
+
+    // wrapped packet
+    if (stream.available() < xbus::pid_s::psize())
+        return info;
+    xbus::pid_s ipid;
+    ipid.read(&stream);
+    info.inner = ipid.uid;
 
-    return true;
+    return info;
 }
 
 void DatalinkConnection::open()
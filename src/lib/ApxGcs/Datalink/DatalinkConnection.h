@@ -23,9 +23,11 @@
 
 #include <Fact/Fact.h>
 #include <QtCore>
+#include <atomic>
 
 #include <fifo.hpp>
 #include <serial/SerialCodec.h>
+class DatalinkEngine;
 
 class DatalinkConnection : public Fact
 {
@@ -51,8 +53,94 @@ public:
                                 quint16 rxNetwork,
                                 quint16 txNetwork);
 
+    // packet header, parsed once at ingress and carried with the packet
+    struct PacketInfo
+    {
+        enum Class : quint8 {
+            Data,    // any other uid
+            Nmt,     // nodes management
+            Vehicle, // vehicle wrapped streams
+        };
+        quint16 size{};
+        quint16 uid{};    // mandala uid
+        quint16 squawk{}; // vehicle streams only
+        quint16 inner{};  // mandala uid of vehicle stream payload
+        quint8 pri{};
+        Class cls{Data};
+        bool valid{};       // pid decoded
+        bool control{true}; // not a service packet, may be blocked for clients
+    };
+    static PacketInfo packetInfo(const void *data, size_t size);
+
+    // ref-counted batch of packets stored back to back with info header,
+    // storage is recycled by the connection once released by all consumers
+    struct Packets
+    {
+        QByteArray data;
+        int cnt{};
+
+        bool isEmpty() const { return cnt == 0; }
+        int count() const { return cnt; }
+        bool isShared() const { return !data.isDetached(); }
+        void append(const PacketInfo &info, const void *src)
+        {
+            data.append(reinterpret_cast<const char *>(&info), sizeof(info));
+            data.append(static_cast<const char *>(src), info.size);
+            cnt++;
+        }
+        void clear()
+        {
+            data.resize(0);
+            cnt = 0;
+        }
+        // f is called with packet info and a non-owning view of each packet
+        template<typename F>
+        void forEach(F f) const
+        {
+            const char *p = data.constData();
+            const char *e = p + data.size();
+            while (p < e) {
+                const PacketInfo info = qFromUnaligned<PacketInfo>(p);
+                p += sizeof(info);
+                f(info, QByteArray::fromRawData(p, info.size));
+                p += info.size;
+            }
+        }
+    };
+
+    // encoded frames of a batch, shared by connections with the same framing
+    struct Frames
+    {
+        QByteArray data;
+
+        struct frame_s
+        {
+            int pos;
+            int size;
+            quint16 uid;    // mandala uid of the packet, payload uid for vehicle streams
+            quint16 squawk; // vehicle streams only
+            bool keep;      // control or nmt packet, never dropped by send queues
+            bool coalesce;  // state update, may be replaced by the next one of the same uid
+        };
+        QVector<frame_s> index;
+
+        bool isEmpty() const { return index.isEmpty(); }
+        int count() const { return index.size(); }
+    };
+
+    // traffic counters, updated by the I/O thread and polled by stats
+    struct Traffic
+    {
+        std::atomic<quint64> rxCnt{};
+        std::atomic<quint64> rxData{};
+        std::atomic<quint64> txCnt{};
+        std::atomic<quint64> txData{};
+    };
+    const Traffic &traffic() const { return _traffic; }
+
     void setEncoder(SerialEncoder *encoder);
     void setDecoder(SerialDecoder *decoder);
+    void setEngine(DatalinkEngine *engine);
 
 public:
     QString url() const;
@@ -75,22 +163,46 @@ public:
 
 protected:
     // helpers
-    bool isControlPacket(const QByteArray &packet) const;
     virtual void resetDataStream();
 
     // interface with codec implementation
     virtual QByteArray read();
     virtual void write(const QByteArray &packet);
+    virtual void sendFrames(const Frames &frames); // writes all frames by default
+    virtual QString descrInfo() const { return QString(); }
 
     SerialEncoder *_encoder{};
     SerialDecoder *_decoder{};
 
+    // I/O device handled by the engine thread while opened
+    QIODevice *_device{};
+    void detachDevice();
+    void scheduleRead();
+
+private:
+    // reusable batch of packets decoded by one readDataAvailable call
+    static constexpr int RXBUF_SIZE{xbus::size_packet_max * 8};
+    static constexpr int RXPOOL_SIZE{8};
+    Packets _rx_packets;
+    QVector<Packets> _rx_pool;
+    void allocPackets();
+    void decode(const QByteArray &data);
+
 private:
-    // receiver fifo and packets queue
-    static constexpr size_t RXBUF_SIZE{xbus::size_packet_max * 8};
-    apx::fifo_packet_static<RXBUF_SIZE> _rx_fifo;
-    QByteArray _rx_pkt{xbus::size_packet_max, '\0'};
-    QByteArray _readPacket();
+    DatalinkEngine *_engine{};
+    Traffic _traffic;
+
+    // GUI thread state published to the I/O thread
+    struct IoState
+    {
+        std::atomic_bool enabled{}; // activated && active
+        std::atomic<quint16> rxNetwork{};
+        std::atomic<quint16> txNetwork{};
+        std::atomic_bool blockControls{};
+        std::atomic_bool blockService{};
+    };
+    IoState _io;
+    void publishState();
 
 private:
     QString m_url;
@@ -117,9 +229,15 @@ public slots:
 
     //export data
 signals:
-    void packetReceived(QByteArray packet, quint16 network);
+    void packetsReceived(DatalinkConnection::Packets packets, quint16 network);
+
+public:
+    // TX path, called by the engine
+    bool acceptsTx(quint16 network) const;
+    size_t framing() const; // encoded frames are shared between equal framings
+    Frames encode(const Packets &packets);
 public slots:
-    void sendPacket(QByteArray packet, quint16 network);
+    void writeFrames(DatalinkConnection::Frames frames);
 
 signals:
     void urlChanged();
@@ -0,0 +1,253 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DatalinkEngine.h"
+
+DatalinkEngine::DatalinkEngine(QObject *parent)
+    : QThread(parent)
+    , _ctx(new QObject)
+{
+    setObjectName("datalink");
+
+    _ctx->moveToThread(this);
+    connect(this, &QThread::finished, _ctx, &QObject::deleteLater);
+
+    _time.start();
+    start(QThread::HighPriority);
+}
+DatalinkEngine::~DatalinkEngine()
+{
+    quit();
+    wait();
+}
+
+void DatalinkEngine::call(const std::function<void()> &f)
+{
+    if (QThread::currentThread() == this || !isRunning()) {
+        f();
+        return;
+    }
+    QMetaObject::invokeMethod(_ctx, f, Qt::BlockingQueuedConnection);
+}
+
+void DatalinkEngine::addConnection(DatalinkConnection *c)
+{
+    connect(c,
+            &DatalinkConnection::packetsReceived,
+            _ctx,
+            [this, c](DatalinkConnection::Packets packets, quint16 network) {
+                receive(c, packets, network);
+            });
+
+    call([this, c]() {
+        int i = _slots.indexOf(nullptr);
+        if (i < 0) {
+            i = _slots.size();
+            _slots.append(c);
+            for (auto &b : _subscribers)
+                b.resize(_slots.size());
+            _local.resize(_slots.size());
+        } else {
+            _slots[i] = c;
+        }
+        _slotIndex.insert(c, i);
+    });
+
+    // keep tx network mask of the subscriber in sync
+    auto update = [this, c]() { updateSubscriber(c); };
+    QList<QMetaObject::Connection> &list = _signals[c];
+    list.append(connect(c, &DatalinkConnection::activatedChanged, c, update));
+    list.append(connect(c, &DatalinkConnection::activeChanged, c, update));
+    list.append(connect(c, &DatalinkConnection::txNetworkChanged, c, update));
+    updateSubscriber(c);
+}
+void DatalinkEngine::removeConnection(DatalinkConnection *c)
+{
+    disconnect(c, nullptr, _ctx, nullptr);
+    for (auto const &i : _signals.take(c))
+        disconnect(i);
+    detach(c);
+    call([this, c]() {
+        int i = _slotIndex.take(c);
+        _slots[i] = nullptr;
+        for (auto &b : _subscribers)
+            b.clearBit(i);
+        _local.clearBit(i);
+    });
+}
+
+void DatalinkEngine::updateSubscriber(DatalinkConnection *c)
+{
+    quint16 txNetwork = c->acceptsTx(0xFFFF) ? c->txNetwork() : 0;
+    QMetaObject::invokeMethod(_ctx, [this, c, txNetwork]() { setSubscriber(c, txNetwork); });
+}
+void DatalinkEngine::setSubscriber(DatalinkConnection *c, quint16 txNetwork)
+{
+    int i = _slotIndex.value(c, -1);
+    if (i < 0)
+        return; // already removed
+    for (int b = 0; b < NETWORK_BITS; ++b)
+        _subscribers[b].setBit(i, txNetwork & (1 << b));
+}
+
+void DatalinkEngine::attach(DatalinkConnection *c, QIODevice *dev)
+{
+    if (dev->thread() == this)
+        return;
+    _owners.insert(dev, dev->parent());
+    dev->setParent(nullptr);
+    dev->moveToThread(this);
+    call([this, c, dev]() {
+        _attached.insert(c, dev);
+        int i = _slotIndex.value(c, -1);
+        if (i >= 0)
+            _local.setBit(i);
+    });
+}
+void DatalinkEngine::detach(DatalinkConnection *c)
+{
+    QThread *t = QThread::currentThread();
+    QIODevice *dev{};
+    call([this, c, t, &dev]() {
+        int i = _slotIndex.value(c, -1);
+        if (i >= 0)
+            _local.clearBit(i);
+        dev = _attached.take(c);
+        if (dev && dev->thread() != t)
+            dev->moveToThread(t);
+    });
+    if (!dev || !_owners.contains(dev))
+        return;
+    // back in the caller thread, hand the device to its original owner
+    QObject *owner = _owners.take(dev);
+    if (owner && owner->thread() == dev->thread())
+        dev->setParent(owner);
+}
+
+void DatalinkEngine::transmit(QByteArray packet, quint16 network)
+{
+    QMetaObject::invokeMethod(_ctx, [this, packet, network]() {
+        DatalinkConnection::Packets packets;
+        const void *data = packet.constData();
+        packets.append(DatalinkConnection::packetInfo(data, static_cast<size_t>(packet.size())),
+                       data);
+        send(packets, network);
+    });
+}
+
+void DatalinkEngine::receive(DatalinkConnection *src,
+                             DatalinkConnection::Packets packets,
+                             quint16 network)
+{
+    if (packets.isEmpty())
+        return;
+    if (!network)
+        return;
+
+    // relay to other connections
+    send(packets, network, src);
+
+    // queue for protocols, one ring entry per PHY read
+    int cnt = packets.count();
+    if (!_rx.push({packets, _time.nsecsElapsed()})) {
+        _overflowCnt += cnt;
+        return;
+    }
+    if (!_rxNotified.exchange(true))
+        emit packetsAvailable();
+}
+void DatalinkEngine::send(const DatalinkConnection::Packets &packets,
+                          quint16 network,
+                          DatalinkConnection *src)
+{
+    // subscribers of any network bit
+    QBitArray targets(_slots.size());
+    for (int b = 0; b < NETWORK_BITS; ++b) {
+        if (network & (1 << b))
+            targets |= _subscribers[b];
+    }
+    int isrc = _slotIndex.value(src, -1);
+    if (isrc >= 0)
+        targets.clearBit(isrc);
+
+    QList<DatalinkConnection *> local;
+    QList<QPointer<DatalinkConnection>> remote;
+    for (int i = 0; i < targets.size(); ++i) {
+        if (!targets.testBit(i))
+            continue;
+        if (_local.testBit(i))
+            local.append(_slots.at(i));
+        else
+            remote.append(_slots.at(i));
+    }
+    write(local, packets, network);
+
+    if (remote.isEmpty())
+        return;
+    // connection I/O lives in the GUI thread, the batch is posted as a whole
+    QMetaObject::invokeMethod(this, [remote, packets, network]() {
+        QList<DatalinkConnection *> list;
+        for (auto c : remote) {
+            if (c)
+                list.append(c);
+        }
+        write(list, packets, network);
+    });
+}
+void DatalinkEngine::write(const QList<DatalinkConnection *> &list,
+                           const DatalinkConnection::Packets &packets,
+                           quint16 network)
+{
+    // frames are encoded once per framing and shared by all connections
+    QHash<size_t, DatalinkConnection::Frames> frames;
+    for (auto c : list) {
+        if (!c->acceptsTx(network))
+            continue;
+        const size_t framing = c->framing();
+        auto it = frames.find(framing);
+        if (it == frames.end())
+            it = frames.insert(framing, c->encode(packets));
+        if (!it.value().isEmpty())
+            c->writeFrames(it.value());
+    }
+}
+
+bool DatalinkEngine::readPackets(DatalinkConnection::Packets &packets)
+{
+    rx_s rx;
+    if (!_rx.pop(rx)) {
+        // re-arm notification and check for packets pushed meanwhile
+        _rxNotified = false;
+        if (!_rx.pop(rx))
+            return false;
+    }
+    int dt = static_cast<int>((_time.nsecsElapsed() - rx.t) / 1000);
+    if (_latency < dt)
+        _latency = dt;
+    packets = rx.packets;
+    return true;
+}
+int DatalinkEngine::takeLatency()
+{
+    int v = _latency;
+    _latency = 0;
+    return v;
+}
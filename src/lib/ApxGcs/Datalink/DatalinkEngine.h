@@ -0,0 +1,107 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "DatalinkConnection.h"
+#include "DatalinkRing.h"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <QtCore>
+
+// Datalink I/O thread.
+// Opened connection devices are moved here, so that framing decoder and
+// relay between connections don't depend on the GUI thread load.
+// Received packets are passed to the protocols through a bounded ring.
+class DatalinkEngine : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit DatalinkEngine(QObject *parent = nullptr);
+    ~DatalinkEngine() override;
+
+    void addConnection(DatalinkConnection *c);
+    void removeConnection(DatalinkConnection *c); // blocks until released by the engine
+
+    // move connection I/O device to the engine thread and back to the caller
+    void attach(DatalinkConnection *c, QIODevice *dev);
+    void detach(DatalinkConnection *c);
+
+    // send packet to all connections, called from the GUI thread
+    void transmit(QByteArray packet, quint16 network);
+
+    // consumer side, GUI thread only
+    bool readPackets(DatalinkConnection::Packets &packets);
+
+    quint64 overflowCnt() const { return _overflowCnt; } // dropped packets
+    int takeLatency(); // max RX queue latency since last call [us]
+
+    static constexpr size_t RX_RING_SIZE{1024}; // batches of packets
+
+private:
+    QObject *_ctx; // lives in the engine thread
+
+    // engine thread data
+    QHash<DatalinkConnection *, QIODevice *> _attached;
+
+    // GUI thread data, device owners restored on detach
+    QHash<QIODevice *, QPointer<QObject>> _owners;
+
+    // subscribers table, each connection owns a slot index in the bit arrays
+    static constexpr int NETWORK_BITS{16};
+    QVector<DatalinkConnection *> _slots;
+    QHash<DatalinkConnection *, int> _slotIndex;
+    std::array<QBitArray, NETWORK_BITS> _subscribers; // slots by tx network bit
+    QBitArray _local;                                 // slots with I/O in the engine thread
+
+    void setSubscriber(DatalinkConnection *c, quint16 txNetwork);
+
+    // GUI thread data
+    QHash<DatalinkConnection *, QList<QMetaObject::Connection>> _signals;
+    void updateSubscriber(DatalinkConnection *c);
+
+    struct rx_s
+    {
+        DatalinkConnection::Packets packets;
+        qint64 t;
+    };
+    DatalinkRing<rx_s, RX_RING_SIZE> _rx;
+    std::atomic_bool _rxNotified{};
+    std::atomic<quint64> _overflowCnt{};
+    int _latency{};
+
+    QElapsedTimer _time;
+
+    void call(const std::function<void()> &f);
+
+    void receive(DatalinkConnection *src, DatalinkConnection::Packets packets, quint16 network);
+    void send(const DatalinkConnection::Packets &packets,
+              quint16 network,
+              DatalinkConnection *src = nullptr);
+    static void write(const QList<DatalinkConnection *> &list,
+                      const DatalinkConnection::Packets &packets,
+                      quint16 network);
+
+signals:
+    void packetsAvailable();
+};
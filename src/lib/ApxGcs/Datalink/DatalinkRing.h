@@ -0,0 +1,69 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// bounded lock-free ring for one producer and one consumer thread
+template<typename T, size_t N>
+class DatalinkRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "ring size must be a power of two");
+
+public:
+    bool push(T &&v)
+    {
+        size_t h = _head.load(std::memory_order_relaxed);
+        if (h - _tail.load(std::memory_order_acquire) >= N)
+            return false;
+        _buf[h & (N - 1)] = std::move(v);
+        _head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(T &v)
+    {
+        size_t t = _tail.load(std::memory_order_relaxed);
+        if (t == _head.load(std::memory_order_acquire))
+            return false;
+        v = std::move(_buf[t & (N - 1)]);
+        _buf[t & (N - 1)] = T();
+        _tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+    size_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    std::array<T, N> _buf{};
+    std::atomic<size_t> _head{}; // written by producer
+    std::atomic<size_t> _tail{}; // written by consumer
+};
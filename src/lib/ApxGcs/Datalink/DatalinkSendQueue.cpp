@@ -0,0 +1,112 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DatalinkSendQueue.h"
+
+void DatalinkSendQueue::push(const DatalinkConnection::Frames &frames)
+{
+    for (auto const &f : frames.index) {
+        quint32 key = f.coalesce ? static_cast<quint32>(f.squawk) << 16 | f.uid : 0;
+        item_s item{frames.data, f.pos, f.size, key, f.keep};
+        if (_policy == Coalesce && coalesce(item))
+            continue;
+        _queue.push_back(item);
+        _bytes += item.size;
+        if (_policy == Coalesce && key)
+            _latest.insert(key, std::prev(_queue.end()));
+    }
+    trim();
+    _depth = static_cast<int>(_queue.size());
+}
+
+bool DatalinkSendQueue::coalesce(const item_s &item)
+{
+    if (item.keep || !item.key)
+        return false;
+    // replace queued frame of the same uid and vehicle in place
+    auto it = _latest.find(item.key);
+    if (it == _latest.end())
+        return false;
+    auto &i = *it.value();
+    _bytes += item.size - i.size;
+    i = item;
+    _dropCnt++;
+    return true;
+}
+
+void DatalinkSendQueue::forget(std::list<item_s>::iterator it)
+{
+    auto i = _latest.find(it->key);
+    if (i != _latest.end() && i.value() == it)
+        _latest.erase(i);
+}
+
+void DatalinkSendQueue::trim()
+{
+    const int limit = _limit;
+    const Policy policy = _policy;
+    while (_bytes > limit && !_queue.empty()) {
+        auto it = _queue.begin();
+        if (policy != DropOldest) {
+            while (it != _queue.end() && it->keep)
+                ++it;
+            // only controls left, allow them to grow up to twice the limit
+            if (it == _queue.end()) {
+                if (_bytes <= limit * 2)
+                    break;
+                it = _queue.begin();
+            }
+        }
+        drop(it);
+    }
+}
+
+void DatalinkSendQueue::drop(std::list<item_s>::iterator it)
+{
+    _bytes -= it->size;
+    forget(it);
+    _queue.erase(it);
+    _dropCnt++;
+}
+
+QByteArray DatalinkSendQueue::take(int size)
+{
+    QByteArray data;
+    while (!_queue.empty()) {
+        const item_s &i = _queue.front();
+        if (!data.isEmpty() && (data.size() + i.size) > size)
+            break;
+        data.append(i.data.constData() + i.pos, i.size);
+        _bytes -= i.size;
+        forget(_queue.begin());
+        _queue.pop_front();
+    }
+    _depth = static_cast<int>(_queue.size());
+    return data;
+}
+
+void DatalinkSendQueue::clear()
+{
+    _queue.clear();
+    _latest.clear();
+    _bytes = 0;
+    _depth = 0;
+}
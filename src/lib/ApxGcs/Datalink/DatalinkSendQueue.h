@@ -0,0 +1,81 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "DatalinkConnection.h"
+#include <QtCore>
+#include <atomic>
+#include <list>
+
+// bounded send queue of encoded frames for remote clients
+class DatalinkSendQueue
+{
+    Q_GADGET
+
+public:
+    enum Policy {
+        DropOldest,   // drop oldest frames when full
+        KeepControls, // drop oldest frames except controls and nmt
+        Coalesce,     // keep the latest state frame per vehicle and uid, then as KeepControls
+    };
+    Q_ENUM(Policy)
+
+    void setPolicy(Policy v) { _policy = v; }
+    void setLimit(int v) { _limit = v; } // bytes
+
+    void push(const DatalinkConnection::Frames &frames);
+
+    // concatenated frames up to size bytes, at least one frame
+    QByteArray take(int size);
+    void clear();
+
+    bool isEmpty() const { return _queue.empty(); }
+
+    // thread safe counters
+    int depth() const { return _depth; }
+    quint64 dropCnt() const { return _dropCnt; }
+
+private:
+    struct item_s
+    {
+        QByteArray data; // shared frames buffer
+        int pos;
+        int size;
+        quint32 key; // payload uid and squawk, zero when not coalesced
+        bool keep;
+    };
+    std::list<item_s> _queue;
+    QHash<quint32, std::list<item_s>::iterator> _latest; // coalesced frames by key
+    int _bytes{};
+
+    // may be changed from any thread
+    std::atomic<Policy> _policy{KeepControls};
+    std::atomic_int _limit{64 * 1024};
+
+    std::atomic_int _depth{};
+    std::atomic<quint64> _dropCnt{};
+
+    bool coalesce(const item_s &item);
+    void trim();
+    void drop(std::list<item_s>::iterator it);
+    void forget(std::list<item_s>::iterator it);
+};
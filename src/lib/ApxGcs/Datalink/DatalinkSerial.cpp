@@ -46,9 +46,15 @@ DatalinkSerial::DatalinkSerial(Fact *parent, QString devName, uint baud)
 {
     setUrl(m_devName);
 
-    dev = new QSerialPort(this);
+    // no parent, the port is moved to the datalink engine thread when opened
+    dev = new QSerialPort();
+    _device = dev;
     connect(dev, &QSerialPort::errorOccurred, this, &DatalinkSerial::serialPortError);
-    connect(dev, &QSerialPort::readyRead, this, &DatalinkSerial::readDataAvailable);
+    connect(dev,
+            &QSerialPort::readyRead,
+            this,
+            &DatalinkSerial::readDataAvailable,
+            Qt::DirectConnection);
 
     connect(this, &DatalinkConnection::activatedChanged, this, [this]() {
         if (activated()) {
@@ -65,6 +71,9 @@ DatalinkSerial::DatalinkSerial(Fact *parent, QString devName, uint baud)
 }
 DatalinkSerial::~DatalinkSerial()
 {
+    detachDevice();
+    delete dev;
+
     if (_encoder)
         delete _encoder;
     if (_decoder)
@@ -196,6 +205,7 @@ bool DatalinkSerial::openPort(const QSerialPortInfo &spi, uint baud)
 }
 void DatalinkSerial::closePort()
 {
+    detachDevice();
     if (lock) {
         lock->unlock();
         delete lock;
@@ -233,6 +243,7 @@ void DatalinkSerial::serialPortError(QSerialPort::SerialPortError error)
         return;
     apxConsoleW() << "Serial error:" << error;
 
+    detachDevice();
     dev->clearError();
     if (dev->isOpen()) {
         closePort();
@@ -264,7 +275,8 @@ void DatalinkSerial::write(const QByteArray &packet)
 
     if (wcnt <= 0) {
         qWarning() << "tx" << wcnt;
-        serialPortError(QSerialPort::WriteError);
+        QMetaObject::invokeMethod(
+            this, [this]() { serialPortError(QSerialPort::WriteError); }, Qt::QueuedConnection);
     }
 
     // qDebug() << "TX" << wcnt << cnt << packet.size()
@@ -286,7 +298,8 @@ QByteArray DatalinkSerial::read()
     // read PHY and continue decoding
     auto rcnt = dev->read(reinterpret_cast<char *>(_rxbuf_raw), sizeof(_rxbuf_raw));
     if (rcnt < 0) {
-        serialPortError(QSerialPort::ReadError);
+        QMetaObject::invokeMethod(
+            this, [this]() { serialPortError(QSerialPort::ReadError); }, Qt::QueuedConnection);
         return {};
     }
     if (rcnt <= 0) {
@@ -294,8 +307,5 @@ QByteArray DatalinkSerial::read()
         return {};
     }
 
-    // schedule reads for next packet
-    QTimer::singleShot(0, this, &DatalinkSerial::readDataAvailable);
-
     return QByteArray(reinterpret_cast<char *>(_rxbuf_raw), rcnt);
 }
@@ -92,9 +92,39 @@ DatalinkServer::DatalinkServer(Datalink *datalink)
     f_extsrv->setDefaultValue(true);
     connect(f_extsrv, &Fact::valueChanged, this, &DatalinkServer::updateClientsNetworkMode);
 
+    f_txpolicy = new Fact(this,
+                          "txpolicy",
+                          tr("Clients send queue"),
+                          tr("Data to drop for slow clients"),
+                          Enum | PersistentValue,
+                          "tray-full");
+    f_txpolicy->setEnumStrings(QMetaEnum::fromType<DatalinkSendQueue::Policy>());
+    f_txpolicy->setDefaultValue(DatalinkSendQueue::KeepControls);
+    connect(f_txpolicy, &Fact::valueChanged, this, &DatalinkServer::updateClientsTxQueue);
+
+    f_txlimit = new Fact(this,
+                         "txlimit",
+                         tr("Send queue size"),
+                         tr("Max data queued per client"),
+                         Int | PersistentValue,
+                         "tray");
+    f_txlimit->setUnits("KB");
+    f_txlimit->setDefaultValue(64);
+    f_txlimit->setMin(4);
+    f_txlimit->setMax(4096);
+    connect(f_txlimit, &Fact::valueChanged, this, &DatalinkServer::updateClientsTxQueue);
+
     f_clients = new Fact(this, "clients", tr("Clients"), tr("Connected clients"), Section | Count);
     connect(f_clients, &Fact::sizeChanged, this, &DatalinkServer::updateStatus);
 
+    // clients send queue status
+    queueTimer.setInterval(1000);
+    connect(&queueTimer, &QTimer::timeout, this, [this]() {
+        for (auto i : f_clients->findFacts<DatalinkSocket>())
+            i->updateQueueStatus();
+    });
+    queueTimer.start();
+
     f_alloff = new Fact(this,
                         "alloff",
                         tr("Disconnect all"),
@@ -234,6 +264,7 @@ void DatalinkServer::newHttpConnection()
         }
         DatalinkTcp *c = new DatalinkTcp(f_clients, socket, 0, 0);
         updateClientsNetworkMode();
+        updateClientsTxQueue();
         connect(f_alloff, &Fact::triggered, c, &DatalinkConnection::close);
         connect(c, &DatalinkTcp::httpRequest, this, &DatalinkServer::httpRequest);
         datalink->addConnection(c);
@@ -275,6 +306,7 @@ void DatalinkServer::udpReadyRead()
 
         qDebug() << "new UDP connection" << c->title();
         updateClientsNetworkMode();
+        updateClientsTxQueue();
         connect(f_alloff, &Fact::triggered, c, [c]() { c->setActive(false); });
         datalink->addConnection(c);
         c->setActivated(true);
@@ -299,3 +331,12 @@ void DatalinkServer::updateClientsNetworkMode()
         i->setBlockService(rxNetwork && (!extsrv));
     }
 }
+
+void DatalinkServer::updateClientsTxQueue()
+{
+    auto policy = f_txpolicy->value().value<DatalinkSendQueue::Policy>();
+    int limit = f_txlimit->value().toInt() * 1024;
+
+    for (auto i : f_clients->findFacts<DatalinkSocket>())
+        i->setTxQueue(policy, limit);
+}
@@ -38,6 +38,9 @@ public:
     Fact *f_extctr;
     Fact *f_extsrv;
 
+    Fact *f_txpolicy;
+    Fact *f_txlimit;
+
     Fact *f_clients;
 
     Fact *f_alloff;
@@ -59,9 +62,12 @@ private:
     QByteArray announceHttpString;
     QByteArray announceUdpString;
 
+    QTimer queueTimer;
+
 private slots:
     void updateStatus();
     void updateClientsNetworkMode();
+    void updateClientsTxQueue();
 
     void httpActiveChanged();
     void tryBindHttpServer();
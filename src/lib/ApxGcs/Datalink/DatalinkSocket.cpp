@@ -61,6 +61,13 @@ DatalinkSocket::DatalinkSocket(Fact *parent,
             &DatalinkSocket::socketError);
 
     connect(_socket, &QAbstractSocket::stateChanged, this, &DatalinkSocket::socketStateChanged);
+
+    // runs in the socket thread while handled by the datalink engine,
+    // datagrams are never buffered and UDP sockets are shared by server clients
+    if (_socket->socketType() == QAbstractSocket::TcpSocket) {
+        connect(
+            _socket, &QIODevice::bytesWritten, this, [this]() { flush(); }, Qt::DirectConnection);
+    }
 }
 
 bool DatalinkSocket::isLocalHost(const QHostAddress address)
@@ -79,6 +86,7 @@ bool DatalinkSocket::isEqual(const QHostAddress address)
 
 void DatalinkSocket::socketDisconnected()
 {
+    detachDevice();
     resetDataStream();
 
     closed();
@@ -129,6 +137,49 @@ void DatalinkSocket::socketStateChanged(QAbstractSocket::SocketState socketState
 
 void DatalinkSocket::close()
 {
+    detachDevice();
     _socket->abort();
     closed();
 }
+
+void DatalinkSocket::resetDataStream()
+{
+    DatalinkConnection::resetDataStream();
+    _txQueue.clear();
+}
+
+void DatalinkSocket::setTxQueue(DatalinkSendQueue::Policy policy, int limit)
+{
+    _txQueue.setPolicy(policy);
+    _txQueue.setLimit(limit);
+}
+
+void DatalinkSocket::sendFrames(const Frames &frames)
+{
+    _txQueue.push(frames);
+    flush();
+}
+
+void DatalinkSocket::flush()
+{
+    while (!_txQueue.isEmpty()) {
+        qint64 avail = TXBUF_SIZE - _socket->bytesToWrite();
+        if (avail <= 0)
+            break;
+        write(_txQueue.take(static_cast<int>(avail)));
+    }
+}
+
+QString DatalinkSocket::descrInfo() const
+{
+    int depth = _txQueue.depth();
+    quint64 drops = _txQueue.dropCnt();
+    if (!(depth || drops))
+        return QString();
+    return QString("Q: %1, dropped: %2").arg(depth).arg(drops);
+}
+
+void DatalinkSocket::updateQueueStatus()
+{
+    updateDescr();
+}
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "DatalinkConnection.h"
+#include "DatalinkSendQueue.h"
 #include <QtCore>
 #include <QtNetwork>
 
@@ -44,9 +45,17 @@ public:
 
     virtual void close() override;
 
+    void setTxQueue(DatalinkSendQueue::Policy policy, int limit);
+    void updateQueueStatus();
+
 private:
     QAbstractSocket *_socket;
 
+    // bounded TX queue, accessed by the socket thread only
+    static constexpr int TXBUF_SIZE{16 * 1024}; // max bytes buffered by the socket
+    DatalinkSendQueue _txQueue;
+    void flush();
+
     CobsDecoder<> _dec;
     CobsEncoder<> _enc;
 
@@ -54,6 +63,11 @@ protected:
     QHostAddress _hostAddress;
     quint16 _hostPort;
 
+    //DatalinkConnection overrided
+    void resetDataStream() override;
+    void sendFrames(const Frames &frames) override;
+    QString descrInfo() const override;
+
 protected slots:
     virtual void socketDisconnected();
     virtual void socketError(QAbstractSocket::SocketError socketError);
@@ -36,16 +36,114 @@ DatalinkStats::DatalinkStats(Datalink *parent)
     f_dnlink = new DatalinkStatsCounter(this, "dnlink", tr("Downlink"), "");
     f_total = new DatalinkStatsCounter(this, "total", tr("Total"), "");
 
-    connect(f_datalink, &Datalink::packetReceived, f_dnlink, [this](QByteArray packet) {
-        uint sz = static_cast<uint>(packet.size());
-        f_dnlink->countData(sz);
-        f_total->countData(sz);
-    });
+    f_telemetry = new DatalinkStatsCounter(this, "telemetry", tr("Telemetry"), "");
+    f_nmt = new DatalinkStatsCounter(this, "nmt", tr("Nodes"), "");
+    f_data = new DatalinkStatsCounter(this, "data", tr("Data"), "");
+
     connect(f_datalink, &Datalink::packetTransmitted, f_dnlink, [this](QByteArray packet) {
         uint sz = static_cast<uint>(packet.size());
         f_uplink->countData(sz);
         f_total->countData(sz);
     });
+
+    // datalink engine RX queue
+    QString sect = tr("Engine");
+    f_latency = new Fact(this, "latency", tr("RX latency"), tr("Max queue delay to protocols"));
+    f_latency->setSection(sect);
+    f_latency->setValue(0);
+    f_overflow = new Fact(this, "overflow", tr("RX overflow"), tr("Packets dropped by RX queue"));
+    f_overflow->setSection(sect);
+    f_overflow->setValue(0);
+
+    updateTimer.setSingleShot(false);
+    updateTimer.setInterval(1777);
+    connect(&updateTimer, &QTimer::timeout, this, &DatalinkStats::updateTimerTimeout);
+    updateTimer.start();
+
+    time.start();
+}
+
+void DatalinkStats::countDownlink(const DatalinkConnection::PacketInfo &info)
+{
+    uint sz = info.size;
+    f_dnlink->countData(sz);
+    f_total->countData(sz);
+
+    if (!info.valid)
+        return;
+
+    switch (info.cls) {
+    case DatalinkConnection::PacketInfo::Vehicle:
+        f_telemetry->countData(sz);
+        break;
+    case DatalinkConnection::PacketInfo::Nmt:
+        f_nmt->countData(sz);
+        break;
+    default:
+        f_data->countData(sz);
+    }
+}
+
+void DatalinkStats::updateTimerTimeout()
+{
+    int t = static_cast<int>(time.restart());
+    if (t <= 0)
+        return;
+
+    for (auto c : {f_uplink, f_dnlink, f_total, f_telemetry, f_nmt, f_data})
+        c->update(t);
+
+    updateEngineStats();
+    updateLinks(t);
+}
+
+void DatalinkStats::updateEngineStats()
+{
+    DatalinkEngine *engine = f_datalink->engine;
+    f_latency->setValue(QString("%1 ms").arg(engine->takeLatency() / 1000.0, 0, 'f', 1));
+    f_overflow->setValue(engine->overflowCnt());
+}
+
+void DatalinkStats::updateLinks(int t)
+{
+    QSet<DatalinkConnection *> alive;
+    for (auto c : f_datalink->connections) {
+        if (!c)
+            continue;
+        alive.insert(c);
+
+        const DatalinkConnection::Traffic &traffic = c->traffic();
+        quint64 rx = traffic.rxData.load(std::memory_order_relaxed);
+        quint64 tx = traffic.txData.load(std::memory_order_relaxed);
+
+        auto it = _links.find(c);
+        if (it == _links.end()) {
+            Fact *f = new Fact(this, QString("link%1").arg(++_linksCnt), "", "");
+            f->setSection(tr("Connections"));
+            it = _links.insert(c, {f, rx, tx});
+        }
+        link_s &link = it.value();
+
+        const QString rxRate = DatalinkStatsCounter::dataToString((rx - link.rxData) * 1000 / t);
+        const QString txRate = DatalinkStatsCounter::dataToString((tx - link.txData) * 1000 / t);
+        link.f->setTitle(c->title());
+        link.f->setDescr(QString("RX: %1 / TX: %2")
+                             .arg(DatalinkStatsCounter::dataToString(rx))
+                             .arg(DatalinkStatsCounter::dataToString(tx)));
+        link.f->setValue(QString("%1/sec / %2/sec").arg(rxRate).arg(txRate));
+        link.rxData = rx;
+        link.txData = tx;
+    }
+
+    // remove closed connections
+    for (auto it = _links.begin(); it != _links.end();) {
+        if (alive.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        it.value().f->deleteFact();
+        it = _links.erase(it);
+    }
 }
 
 DatalinkStatsCounter::DatalinkStatsCounter(DatalinkStats *parent,
@@ -53,12 +151,6 @@ DatalinkStatsCounter::DatalinkStatsCounter(DatalinkStats *parent,
                                            QString title,
                                            QString descr)
     : Fact(parent, name, title, descr, Section)
-    , packetCnt(0)
-    , packetCntT(0)
-    , packetRate(0)
-    , dataCnt(0)
-    , dataCntT(0)
-    , dataRate(0)
 {
     f_cnt = new Fact(this, "cnt", tr("Packets counter"), "");
     f_cnt->setSection(title);
@@ -72,43 +164,32 @@ DatalinkStatsCounter::DatalinkStatsCounter(DatalinkStats *parent,
     f_datarate = new Fact(this, "datarate", tr("Data rate"), "");
     f_datarate->setSection(title);
     f_datarate->setValue(0);
-
-    updateTimer.setSingleShot(false);
-    updateTimer.setInterval(1777);
-    connect(&updateTimer, &QTimer::timeout, this, &DatalinkStatsCounter::updateTimerTimeout);
-    updateTimer.start();
-
-    time.start();
 }
 
-void DatalinkStatsCounter::countData(uint size)
+void DatalinkStatsCounter::update(int t)
 {
-    packetCnt++;
-    dataCnt += size;
-    f_cnt->setValue(packetCnt);
-}
+    quint64 pcnt = packetCnt.load(std::memory_order_relaxed);
+    quint64 dcnt = dataCnt.load(std::memory_order_relaxed);
 
-void DatalinkStatsCounter::updateTimerTimeout()
-{
-    //data count
-    f_datacnt->setValue(dataToString(dataCnt));
+    //counters
+    f_cnt->setValue(pcnt);
+    f_datacnt->setValue(dataToString(dcnt));
 
     //rate
-    int t = time.restart();
-    f_datarate->setValue(dataToString(getRate(&dataRate, dataCnt - dataCntT, t)) + "/sec");
-    dataCntT = dataCnt;
-    f_rate->setValue(QString::number((packetCnt - packetCntT) * 1000 / t) + "/sec");
-    packetCntT = packetCnt;
+    f_datarate->setValue(dataToString(getRate(&dataRate, dcnt - dataCntT, t)) + "/sec");
+    dataCntT = dcnt;
+    f_rate->setValue(QString::number((pcnt - packetCntT) * 1000 / t) + "/sec");
+    packetCntT = pcnt;
 }
 
-double DatalinkStatsCounter::getRate(double *v, uint dcnt, uint t)
+double DatalinkStatsCounter::getRate(double *v, quint64 dcnt, int t)
 {
     double vt = (double) dcnt / (double) t * 1000.0;
     *v = (*v) * 0.5 + vt * 0.5;
     return *v;
 }
 
-QString DatalinkStatsCounter::dataToString(uint v)
+QString DatalinkStatsCounter::dataToString(quint64 v)
 {
     if (v < 1024)
         return QString("%1 bytes").arg(v);
@@ -21,8 +21,11 @@
  */
 #pragma once
 
+#include "DatalinkConnection.h"
 #include <Fact/Fact.h>
 #include <QtCore>
+#include <atomic>
+
 class Datalink;
 class DatalinkStatsCounter;
 
@@ -38,6 +41,36 @@ public:
     DatalinkStatsCounter *f_dnlink;
 
     DatalinkStatsCounter *f_total;
+
+    // downlink by mandala uid class
+    DatalinkStatsCounter *f_telemetry;
+    DatalinkStatsCounter *f_nmt;
+    DatalinkStatsCounter *f_data;
+
+    Fact *f_latency;
+    Fact *f_overflow;
+
+    // GUI thread, called for each packet passed to protocols
+    void countDownlink(const DatalinkConnection::PacketInfo &info);
+
+private:
+    QTimer updateTimer;
+    QElapsedTimer time;
+
+    struct link_s
+    {
+        Fact *f;
+        quint64 rxData;
+        quint64 txData;
+    };
+    QHash<DatalinkConnection *, link_s> _links;
+    int _linksCnt{};
+
+    void updateEngineStats();
+    void updateLinks(int t);
+
+private slots:
+    void updateTimerTimeout();
 };
 
 class DatalinkStatsCounter : public Fact
@@ -51,24 +84,25 @@ public:
     Fact *f_datacnt;
     Fact *f_datarate;
 
-private:
-    uint packetCnt;
-    uint packetCntT;
-    double packetRate;
+    // called on the hot path from any thread
+    void countData(uint size)
+    {
+        packetCnt.fetch_add(1, std::memory_order_relaxed);
+        dataCnt.fetch_add(size, std::memory_order_relaxed);
+    }
 
-    uint dataCnt;
-    uint dataCntT;
-    double dataRate;
+    // publish counters to facts, t is the time since last update [ms]
+    void update(int t);
 
-    QElapsedTimer time;
-    QTimer updateTimer;
+    static QString dataToString(quint64 v);
 
-    QString dataToString(uint v);
-    double getRate(double *v, uint dcnt, uint t);
+private:
+    std::atomic<quint64> packetCnt{};
+    quint64 packetCntT{};
 
-private slots:
-    void updateTimerTimeout();
+    std::atomic<quint64> dataCnt{};
+    quint64 dataCntT{};
+    double dataRate{};
 
-public slots:
-    void countData(uint size);
+    double getRate(double *v, quint64 dcnt, int t);
 };
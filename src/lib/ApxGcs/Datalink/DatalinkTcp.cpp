@@ -32,6 +32,7 @@ DatalinkTcp::DatalinkTcp(Fact *parent, QTcpSocket *socket, quint16 rxNetwork, qu
     , _tcp(socket)
     , serverName(App::username())
 {
+    _device = _tcp;
     _serverClient = _tcp->isOpen();
 
     _tcp->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
@@ -57,6 +58,7 @@ void DatalinkTcp::connectToHost(QHostAddress host, quint16 port)
         return;
     _hostAddress = host;
     _hostPort = port;
+    detachDevice();
     if (_tcp->isOpen())
         _tcp->abort();
     connect(_tcp, &QTcpSocket::readyRead, this, &DatalinkTcp::readyReadHeader);
@@ -91,10 +93,14 @@ void DatalinkTcp::readyReadHeader()
     if (!data.datalink)
         return;
     setStatus("Datalink");
-    opened();
     disconnect(_tcp, &QTcpSocket::readyRead, this, &DatalinkTcp::readyReadHeader);
-    connect(_tcp, &QTcpSocket::readyRead, this, &DatalinkTcp::readDataAvailable);
-    readDataAvailable();
+    connect(_tcp,
+            &QTcpSocket::readyRead,
+            this,
+            &DatalinkTcp::readDataAvailable,
+            Qt::DirectConnection);
+    opened();
+    scheduleRead();
 }
 
 bool DatalinkTcp::checkHeader()
@@ -20,13 +20,320 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TelemetryFile.h"
-#include "TelemetryFileFormat.h"
 
 #include <App/AppDirs.h>
+#include <App/AppLog.h>
+#include <Database/TelemetryFileFormat.h>
 #include <Vehicles/Vehicle.h>
 
+#include <QFloat16>
+#include <cmath>
+
 using namespace telemetry;
 
+// crc checkpoint interval [ms]
+#define TELEMETRY_FILE_CRC_INTERVAL 1000
+
 TelemetryFile::TelemetryFile() {}
 
-void TelemetryFile::create(Vehicle *vehicle) {}
+TelemetryFile::~TelemetryFile()
+{
+    close();
+}
+
+bool TelemetryFile::create(Vehicle *vehicle)
+{
+    close();
+
+    QDir dir(AppDirs::telemetry());
+    if (!dir.exists())
+        dir.mkpath(".");
+
+    const auto timestamp = QDateTime::currentDateTime();
+
+    QString callsign = vehicle->title();
+    callsign.replace(QRegExp("[^A-Za-z0-9_\\-]"), "_");
+    QString fname = QString("%1-%2.%3")
+                        .arg(timestamp.toString("yyyy_MM_dd_HH_mm_ss_zzz"))
+                        .arg(callsign)
+                        .arg(telemetry::suffix);
+
+    setFileName(dir.absoluteFilePath(fname));
+    if (!open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        apxConsoleW() << "telemetry file:" << errorString() << QFile::fileName();
+        return false;
+    }
+
+    fhdr_s fhdr;
+    memset(&fhdr, 0, sizeof(fhdr));
+    strncpy(fhdr.magic.magic, telemetry::magic, sizeof(fhdr.magic.magic));
+    fhdr.magic.version = telemetry::version;
+    fhdr.ts_file = static_cast<uint64_t>(timestamp.toMSecsSinceEpoch());
+    fhdr.data_offset = sizeof(fhdr);
+
+    // tags are zero terminated strings
+    QByteArray tags;
+    tags.append(QString("callsign:%1").arg(vehicle->title()).toUtf8()).append('\0');
+    tags.append(QString("vehicle:%1").arg(vehicle->uid()).toUtf8()).append('\0');
+    const QString conf = vehicle->confTitle();
+    if (!conf.isEmpty())
+        tags.append(QString("conf:%1").arg(conf).toUtf8()).append('\0');
+    memcpy(fhdr.tags, tags.constData(), qMin(tags.size(), (int) sizeof(fhdr.tags) - 1));
+
+    if (QFile::write(reinterpret_cast<const char *>(&fhdr), sizeof(fhdr)) != sizeof(fhdr)) {
+        apxConsoleW() << "telemetry file:" << errorString() << QFile::fileName();
+        QFile::close();
+        return false;
+    }
+
+    _fields.clear();
+    _vidx = -1;
+    _ts = 0;
+    _ts_crc = 0;
+    _crc = telemetry::crc32_init;
+    _buf.clear();
+
+    return true;
+}
+
+void TelemetryFile::close()
+{
+    if (!isOpen())
+        return;
+    write_crc();
+    QFile::close();
+}
+
+void TelemetryFile::write_values(quint64 timestamp_ms, const PBase::Values &values, bool uplink)
+{
+    if (!isOpen() || values.isEmpty())
+        return;
+
+    if (uplink) {
+        write_uplink(static_cast<quint32>(timestamp_ms), values);
+        return;
+    }
+
+    write_ts(static_cast<quint32>(timestamp_ms));
+
+    // sort by field index to fit deltas in 8 bit specifiers
+    using seq_item = QPair<uint, const PBase::Values::value_s *>;
+    QVarLengthArray<seq_item, 256> seq;
+    bool new_fields = false;
+    for (auto const &v : values) {
+        const int vidx = field_vidx(v.uid, &new_fields);
+        if (vidx < 0)
+            continue;
+        seq.append(qMakePair(static_cast<uint>(vidx), &v));
+    }
+    if (new_fields)
+        _buf.append('\0'); // fields list terminator
+
+    std::sort(seq.begin(), seq.end(), [](const seq_item &a, const seq_item &b) {
+        return a.first < b.first;
+    });
+
+    for (auto const &i : seq)
+        write_value(i.first, *i.second);
+
+    flush_record();
+}
+
+void TelemetryFile::write_evt(quint64 timestamp_ms,
+                              const QString &name,
+                              const QString &value,
+                              const QString &uid,
+                              bool uplink)
+{
+    if (!isOpen())
+        return;
+    write_ext(static_cast<uint8_t>(extid_e::evt));
+    append_le<quint32>(static_cast<quint32>(timestamp_ms));
+    _buf.append(static_cast<char>(uplink ? 1 : 0));
+    write_string(name);
+    write_string(value);
+    write_string(uid);
+    flush_record();
+}
+
+void TelemetryFile::write_msg(quint64 timestamp_ms, const QString &text, const QString &uid)
+{
+    if (!isOpen())
+        return;
+    write_ext(static_cast<uint8_t>(extid_e::msg));
+    append_le<quint32>(static_cast<quint32>(timestamp_ms));
+    write_string(text);
+    write_string(uid);
+    flush_record();
+}
+
+void TelemetryFile::write_ts(quint32 ts)
+{
+    if (_ts == ts && !_fields.isEmpty())
+        return;
+    _ts = ts;
+    write_ext(static_cast<uint8_t>(extid_e::ts));
+    append_le<quint32>(ts);
+
+    if ((ts - _ts_crc) < TELEMETRY_FILE_CRC_INTERVAL)
+        return;
+    _ts_crc = ts;
+    write_crc();
+}
+
+void TelemetryFile::write_crc()
+{
+    flush_record();
+    write_ext(static_cast<uint8_t>(extid_e::crc));
+    append_le<quint32>(_crc);
+    flush_record();
+}
+
+void TelemetryFile::write_uplink(quint32 ts, const PBase::Values &values)
+{
+    // field names must be known before the records refer them
+    QVarLengthArray<int, 16> seq;
+    bool new_fields = false;
+    for (auto const &v : values)
+        seq.append(field_vidx(v.uid, &new_fields));
+    if (new_fields)
+        _buf.append('\0'); // fields list terminator
+
+    // one record per value, not affecting the downlink index delta
+    int i = 0;
+    for (auto const &v : values) {
+        const int vidx = seq.at(i++);
+        if (vidx < 0)
+            continue;
+        write_ext(static_cast<uint8_t>(extid_e::uplink));
+        append_le<quint32>(ts);
+        write_value(static_cast<uint>(vidx), v, false);
+    }
+    flush_record();
+}
+
+int TelemetryFile::field_vidx(mandala::uid_t uid, bool *new_fields)
+{
+    auto it = _fields.find(uid);
+    if (it != _fields.end())
+        return static_cast<int>(it.value());
+
+    const uint vidx = static_cast<uint>(_fields.size());
+    if (vidx > telemetry::vidx_max) {
+        qWarning() << "too many fields" << uid;
+        return -1;
+    }
+    if (!*new_fields) {
+        *new_fields = true;
+        write_ext(static_cast<uint8_t>(extid_e::fields));
+    }
+    write_string(Mandala::meta(uid).path);
+    _fields.insert(uid, vidx);
+    return static_cast<int>(vidx);
+}
+
+void TelemetryFile::write_value(uint vidx, const PBase::Values::value_s &value, bool delta)
+{
+    if (value.type == PBase::Values::Null) {
+        write_dspec(static_cast<uint8_t>(dspec_e::null), vidx, delta);
+        return;
+    }
+
+    bool is_unsigned = false;
+    quint64 u = 0;
+    double d = 0;
+
+    if (value.type == PBase::Values::UInt) {
+        u = value.raw.u;
+        is_unsigned = true;
+    } else {
+        d = value.toDouble();
+        if (d >= 0 && d <= std::numeric_limits<quint32>::max() && std::floor(d) == d) {
+            u = static_cast<quint64>(d);
+            is_unsigned = true;
+        }
+    }
+
+    if (is_unsigned) {
+        if (u <= std::numeric_limits<quint8>::max()) {
+            write_dspec(static_cast<uint8_t>(dspec_e::u8), vidx, delta);
+            append_le<quint8>(static_cast<quint8>(u));
+        } else if (u <= std::numeric_limits<quint16>::max()) {
+            write_dspec(static_cast<uint8_t>(dspec_e::u16), vidx, delta);
+            append_le<quint16>(static_cast<quint16>(u));
+        } else if (u <= 0xFFFFFF) {
+            write_dspec(static_cast<uint8_t>(dspec_e::u24), vidx, delta);
+            append_le<quint16>(static_cast<quint16>(u));
+            append_le<quint8>(static_cast<quint8>(u >> 16));
+        } else if (u <= std::numeric_limits<quint32>::max()) {
+            write_dspec(static_cast<uint8_t>(dspec_e::u32), vidx, delta);
+            append_le<quint32>(static_cast<quint32>(u));
+        } else {
+            write_dspec(static_cast<uint8_t>(dspec_e::u64), vidx, delta);
+            append_le<quint64>(u);
+        }
+        return;
+    }
+
+    // use the narrowest lossless floating point format
+    const float f = static_cast<float>(d);
+    if (static_cast<double>(f) != d) {
+        write_dspec(static_cast<uint8_t>(dspec_e::f64), vidx, delta);
+        append_le<double>(d);
+        return;
+    }
+    const qfloat16 h(f);
+    if (static_cast<float>(h) == f) {
+        write_dspec(static_cast<uint8_t>(dspec_e::f16), vidx, delta);
+        quint16 raw;
+        memcpy(&raw, &h, sizeof(raw));
+        append_le<quint16>(raw);
+        return;
+    }
+    write_dspec(static_cast<uint8_t>(dspec_e::f32), vidx, delta);
+    append_le<float>(f);
+}
+
+void TelemetryFile::write_string(const QString &s)
+{
+    _buf.append(s.toUtf8()).append('\0');
+}
+
+void TelemetryFile::write_dspec(uint8_t dspec, uint vidx, bool delta)
+{
+    dspec_s spec{};
+    if (delta) {
+        const int d = static_cast<int>(vidx) - _vidx;
+        _vidx = static_cast<int>(vidx);
+
+        if (d >= 1 && d <= 8) {
+            spec.spec8.dspec = static_cast<dspec_e>(dspec);
+            spec.spec8.opt = true;
+            spec.spec8.vidx_delta = static_cast<uint>(d - 1);
+            _buf.append(static_cast<char>(spec._raw8));
+            return;
+        }
+    }
+    spec.spec16.dspec = static_cast<dspec_e>(dspec);
+    spec.spec16.opt = false;
+    spec.spec16.vidx = vidx;
+    append_le<quint16>(spec._raw16);
+}
+
+void TelemetryFile::write_ext(uint8_t extid)
+{
+    dspec_s spec{};
+    spec.spec_ext.dspec = dspec_e::ext;
+    spec.spec_ext.extid = static_cast<extid_e>(extid);
+    _buf.append(static_cast<char>(spec._raw8));
+}
+
+void TelemetryFile::flush_record()
+{
+    if (_buf.isEmpty())
+        return;
+    _crc = telemetry::crc32(_buf.constData(), static_cast<size_t>(_buf.size()), _crc);
+    if (QFile::write(_buf) != _buf.size())
+        apxConsoleW() << "telemetry file:" << errorString();
+    _buf.clear();
+}
@@ -21,6 +21,7 @@
  */
 #pragma once
 
+#include <Protocols/PBase.h>
 #include <QtCore>
 
 class Vehicle;
@@ -29,8 +30,51 @@ class TelemetryFile : private QFile
 {
 public:
     explicit TelemetryFile();
+    ~TelemetryFile();
 
-    void create(Vehicle *vehicle);
+    bool create(Vehicle *vehicle);
+    void close() override;
+
+    using QFile::fileName;
+    using QFile::isOpen;
+
+    // data stream, timestamps [ms] relative to file
+    void write_values(quint64 timestamp_ms, const PBase::Values &values, bool uplink);
+    void write_evt(quint64 timestamp_ms,
+                   const QString &name,
+                   const QString &value,
+                   const QString &uid,
+                   bool uplink);
+    void write_msg(quint64 timestamp_ms, const QString &text, const QString &uid);
 
 private:
+    QHash<mandala::uid_t, uint> _fields; // uid to vidx map
+    int _vidx{-1};                       // last written vidx
+
+    quint32 _ts{};     // last written timestamp
+    quint32 _ts_crc{}; // last crc timestamp
+    uint32_t _crc{};
+
+    QByteArray _buf; // record assembly buffer
+
+    // stream data is little endian
+    template<typename T>
+    inline void append_le(T v)
+    {
+        _buf.append(reinterpret_cast<const char *>(&v), sizeof(T));
+    }
+
+    void write_ts(quint32 ts);
+    void write_crc();
+    void write_uplink(quint32 ts, const PBase::Values &values);
+    void write_value(uint vidx, const PBase::Values::value_s &value, bool delta = true);
+    void write_string(const QString &s);
+
+    // returns field index or -1, starts fields record when new
+    int field_vidx(mandala::uid_t uid, bool *new_fields);
+
+    void write_dspec(uint8_t dspec, uint vidx, bool delta);
+    void write_ext(uint8_t extid);
+
+    void flush_record();
 };
@@ -239,6 +239,8 @@ quint64 TelemetryImport::read(QXmlStreamReader &xml)
         break;
     } //while ok
 
+    dbFlushData();
+
     if (isInterruptionRequested()) {
         ok = false;
     } else if (ok && telemetryID) {
@@ -325,7 +327,22 @@ quint64 TelemetryImport::dbSaveID(
 }
 void TelemetryImport::dbSaveData(quint64 time_ms, PBase::Values values, bool uplink)
 {
-    DBReqTelemetryWriteData *req = new DBReqTelemetryWriteData(telemetryID, time_ms, values, uplink);
+    if (!reqBatch)
+        reqBatch = new DBReqTelemetryWriteBatch(telemetryID);
+    reqBatch->append(time_ms, values, uplink);
+    if (reqBatch->size() >= 10000)
+        dbFlushData();
+}
+void TelemetryImport::dbFlushData()
+{
+    if (!reqBatch)
+        return;
+    auto req = reqBatch;
+    reqBatch = nullptr;
+    if (isInterruptionRequested()) {
+        delete req;
+        return;
+    }
     req->exec();
 }
 void TelemetryImport::dbSaveEvent(
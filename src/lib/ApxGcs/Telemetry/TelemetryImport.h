@@ -25,6 +25,8 @@
 #include <Database/DatabaseRequest.h>
 #include <Protocols/PBase.h>
 
+class DBReqTelemetryWriteBatch;
+
 class TelemetryImport : public QueueWorker
 {
     Q_OBJECT
@@ -59,7 +61,9 @@ private:
     quint64 dbReadSharedHashId(QString hash);
     quint64 dbSaveID(
         QString vehicleUID, QString callsign, QString comment, bool rec, quint64 timestamp);
+    DBReqTelemetryWriteBatch *reqBatch{};
     void dbSaveData(quint64 time_ms, PBase::Values values, bool uplink);
+    void dbFlushData();
     void dbSaveEvent(quint64 time_ms,
                      const QString &name,
                      const QString &value,
@@ -33,6 +33,9 @@
 #include <Mission/VehicleMission.h>
 #include <Nodes/Nodes.h>
 
+// fast replay time slice before yielding to event loop [ms]
+#define TELEMETRY_FAST_SLICE 50
+
 TelemetryPlayer::TelemetryPlayer(Telemetry *telemetry, Fact *parent)
     : Fact(parent, "player", tr("Player"), tr("Telemetry data player"), Group)
     , telemetry(telemetry)
@@ -62,6 +65,19 @@ TelemetryPlayer::TelemetryPlayer(Telemetry *telemetry, Fact *parent)
     f_speed->setValue(1);
     connect(f_speed, &Fact::valueChanged, this, &TelemetryPlayer::updateSpeed);
 
+    f_fast = new Fact(this,
+                      "fast",
+                      tr("Fast replay"),
+                      tr("Replay as fast as possible without real time pacing"),
+                      Bool);
+    connect(f_fast, &Fact::valueChanged, this, &TelemetryPlayer::updateSpeed);
+
+    f_quiet = new Fact(this,
+                       "quiet",
+                       tr("Quiet"),
+                       tr("Suppress UI updates and messages in fast replay"),
+                       Bool);
+
     //actions
     f_play = new Fact(this, "play", tr("Play"), tr("Play stream"), Action | Apply, "play");
     connect(f_play, &Fact::triggered, this, &TelemetryPlayer::play);
@@ -93,7 +109,7 @@ TelemetryPlayer::TelemetryPlayer(Telemetry *telemetry, Fact *parent)
 
 void TelemetryPlayer::updateActions()
 {
-    bool enb = cacheID;
+    bool enb = cacheID || _file;
     bool playing = active();
     f_play->setEnabled(enb && (!playing));
     f_stop->setEnabled(enb && (playing));
@@ -111,19 +127,26 @@ void TelemetryPlayer::reset()
     f_time->setValue(0);
     f_speed->setValue(1.0);
     cacheID = 0;
+    _file = nullptr;
+    factByVidx.clear();
+    streams.clear();
+    sched = {};
     updateActions();
 }
 void TelemetryPlayer::setCacheId(quint64 v)
 {
-    if (cacheID)
+    if (cacheID || _file)
         reset();
     cacheID = v;
+    _file = telemetry->f_reader->file;
     updateActions();
 }
 
 void TelemetryPlayer::updateSpeed()
 {
     _speed = f_speed->value().toDouble();
+    _fast = f_fast->value().toBool();
+    f_speed->setEnabled(!_fast);
     if (active()) {
         playTime0 = _time;
         playTime.start();
@@ -162,6 +185,11 @@ void TelemetryPlayer::play()
     playTime0 = _time;
     playTime.start();
 
+    if (_file) {
+        playFile();
+        return;
+    }
+
     //fill facts map
     if (factByDBID.isEmpty()) {
         for (auto f : vehicle->f_mandala->valueFacts()) {
@@ -170,19 +198,100 @@ void TelemetryPlayer::play()
     }
 
     //collect data samples for t0
-    double t = _time / 1000.0;
-    for (auto fieldID : telemetry->f_reader->fieldData.keys()) {
-        Fact *f = factByDBID.value(fieldID);
-        if (!f)
+    seekStreams(_time);
+    tNext = _time;
+    dbRequestEvents(tNext);
+}
+void TelemetryPlayer::playFile()
+{
+    //fill facts map
+    if (factByVidx.size() != _file->fields().size()) {
+        factByVidx.clear();
+        for (auto const &name : _file->fields())
+            factByVidx.append(vehicle->f_mandala->fact(name, true));
+    }
+
+    //restore values state at t0
+    const quint32 ts = static_cast<quint32>(_time);
+    const QVector<double> values = _file->values_at(ts);
+    for (int i = 0; i < values.size(); ++i) {
+        Fact *f = factByVidx.value(i);
+        if (!f || qIsNaN(values.at(i)))
             continue;
-        f->setValue(sampleValue(fieldID, t));
+        f->setValue(values.at(i));
     }
+
+    //latest mission and nodes config or the first available
+    QString mission, nodes;
+    QList<TelemetryFileReader::record_s> conf;
+    for (auto const &e : _file->events_until(_file->duration())) {
+        if (e.type != TelemetryFileReader::rec_e::evt)
+            continue;
+        if (e.name == "mission") {
+            if (e.ts <= ts || mission.isEmpty())
+                mission = e.uid;
+        } else if (e.name == "nodes") {
+            if (e.ts <= ts || nodes.isEmpty())
+                nodes = e.uid;
+        } else if (e.name == "conf" && e.ts <= ts) {
+            conf.append(e);
+        }
+    }
+    if (!mission.isEmpty())
+        vehicle->f_mission->storage->loadMission(mission);
+    if (!nodes.isEmpty())
+        vehicle->storage()->loadVehicleConfig(nodes);
+    for (auto const &e : conf)
+        loadConfValue(e.uid, e.text);
+
+    //replay strictly after t0, values and configs at t0 are restored above
+    _file->seek(ts);
+    _recPending = false;
+    while (_file->next(&_rec)) {
+        if (_rec.ts > ts) {
+            _recPending = true;
+            break;
+        }
+        if (_rec.type == TelemetryFileReader::rec_e::value)
+            continue;
+        if (_rec.type == TelemetryFileReader::rec_e::evt
+            && (_rec.name == "mission" || _rec.name == "nodes" || _rec.name == "conf"))
+            continue;
+        playRecord(_rec);
+    }
+
     tNext = _time;
-    dbRequestEvents(tNext);
+    playTime.start();
+    next();
+}
+void TelemetryPlayer::seekStreams(quint64 t)
+{
+    streams.clear();
+    sched = {};
+    const double tf = t / 1000.0;
+    const auto &fieldData = telemetry->f_reader->fieldData;
+    for (auto i = fieldData.begin(); i != fieldData.end(); ++i) {
+        const QVector<QPointF> *pts = i.value();
+        Fact *f = factByDBID.value(i.key());
+        if (!(f && pts && !pts->isEmpty()))
+            continue;
+        //first sample after t
+        auto it = std::upper_bound(pts->begin(), pts->end(), tf, [](double v, const QPointF &p) {
+            return v < p.x();
+        });
+        int pos = static_cast<int>(it - pts->begin());
+        f->setValue(pts->at(pos > 0 ? pos - 1 : 0).y());
+        if (pos >= pts->size())
+            continue;
+        sched.push({static_cast<quint64>(pts->at(pos).x() * 1000.0), streams.size()});
+        streams.append({pts, f, pos});
+    }
 }
 void TelemetryPlayer::stop()
 {
     setActive(false);
+    flushQuiet();
+    _fastUpdCnt = 0;
     emit discardRequests();
     events.clear();
 }
@@ -296,38 +405,142 @@ void TelemetryPlayer::loadConfValue(const QString &sn, QString s)
     node->loadConfigValue(spath, sv);
 }
 
-void TelemetryPlayer::next()
+bool TelemetryPlayer::playRecord(const TelemetryFileReader::record_s &rec)
 {
-    if (!active())
+    switch (rec.type) {
+    default:
+        return false;
+    case TelemetryFileReader::rec_e::value: {
+        if (rec.null)
+            return false;
+        Fact *f = factByVidx.value(static_cast<int>(rec.vidx));
+        if (!f)
+            return false;
+        return playValue(f, rec.value);
+    }
+    case TelemetryFileReader::rec_e::uplink: {
+        if (rec.null)
+            return false;
+        Fact *f = factByVidx.value(static_cast<int>(rec.vidx));
+        return playUplink(static_cast<MandalaFact *>(f), rec.value);
+    }
+    case TelemetryFileReader::rec_e::evt:
+        playEvent(rec.name, rec.text, rec.uid, rec.uplink);
+        return false;
+    case TelemetryFileReader::rec_e::msg:
+        playEvent(rec.name, rec.text, rec.uid, false);
+        return false;
+    }
+}
+bool TelemetryPlayer::quiet() const
+{
+    return _fast && f_quiet->value().toBool();
+}
+bool TelemetryPlayer::playValue(Fact *f, const QVariant &v)
+{
+    if (!quiet())
+        return f->setValue(v);
+    _quietPending = true;
+    return static_cast<MandalaFact *>(f)->setValueQuiet(v);
+}
+void TelemetryPlayer::flushQuiet()
+{
+    //single notification pass for values updated in quiet mode
+    if (!_quietPending)
         return;
-    quint64 t = playTime.elapsed();
-    if (_speed > 0 && _speed != 1.0)
-        t = t * _speed;
-    t += playTime0;
+    _quietPending = false;
+    for (auto f : vehicle->f_mandala->valueFacts())
+        f->flush();
+}
+bool TelemetryPlayer::playUplink(MandalaFact *f, const QVariant &v)
+{
+    if (!f)
+        return false;
+    bool rv = playValue(f, v);
+    const QString &s = f->mpath();
+    if (s.startsWith("cmd.rc."))
+        return rv;
+    if (s.startsWith("cmd.gimbal."))
+        return rv;
+    if (quiet())
+        return rv;
+    vehicle->message(QString("%1: %2 = %3").arg(">").arg(f->title()).arg(f->text()),
+                     AppNotify::Important);
+    return rv;
+}
+void TelemetryPlayer::playEvent(const QString &evt, QString sv, const QString &uid, bool uplink)
+{
+    if (evt == "msg") {
+        if (quiet())
+            return;
+        QString s = sv;
+        QString sub;
+        if (s.startsWith('[')) {
+            s.remove(0, 1);
+            sub = s.left(s.indexOf(']'));
+            s.remove(0, sub.size() + 1);
+        }
+        vehicle->message(QString("<: %1").arg(s),
+                         AppNotify::FromVehicle | AppNotify::Important,
+                         sub);
+        App::sound(sv);
+        return;
+    }
+    if (evt == "mission") {
+        vehicle->f_mission->storage->loadMission(uid);
+    } else if (evt == "nodes") {
+        vehicle->storage()->loadVehicleConfig(uid);
+    } else if (evt == "conf") {
+        loadConfValue(uid, sv);
+        QString fn = sv.left(sv.indexOf('='));
+        if (sv.size() > (fn.size() + 32) || sv.contains('\n')) {
+            sv = fn + "=<data>";
+        }
+    } else if (evt == "serial") {
+        qDebug() << evt << sv;
+        return;
+    }
+    if (quiet())
+        return;
+    AppNotify::NotifyFlags flags = AppNotify::Important;
+    if (!uplink)
+        flags |= AppNotify::FromVehicle;
+    QString s = QString("%1: %2").arg(uplink ? ">" : "<").arg(evt);
+    if (!sv.isEmpty())
+        s.append(QString(" (%1)").arg(sv));
+    vehicle->message(s, flags);
+}
 
+uint TelemetryPlayer::replay(quint64 t, quint64 &tNextMin)
+{
     uint updCnt = 0;
-    if (tNext <= t) {
-        quint64 tNextMin = tNext;
-        //mandala data
-        for (const auto fieldID : telemetry->f_reader->fieldData.keys()) {
-            QVector<QPointF> *pts = telemetry->f_reader->fieldData.value(fieldID);
-            if (!pts)
-                continue;
-            for (int i = dataPosMap.value(fieldID); i < pts->size(); ++i) {
-                const QPointF &p = pts->at(i);
-                quint64 tP = p.x() * 1000.0;
-                if (tP > tNext) {
-                    if (tNextMin == tNext || tNextMin > tP)
-                        tNextMin = tP;
-                    break;
-                }
-                dataPosMap[fieldID] = i;
-                Fact *f = factByDBID.value(fieldID);
-                if (f) {
-                    if (f->setValue(p.y()))
-                        updCnt++;
-                }
+    if (_file) {
+        //binary file stream
+        while (_recPending || _file->next(&_rec)) {
+            _recPending = false;
+            if (_rec.ts > t) {
+                tNextMin = _rec.ts;
+                _recPending = true;
+                break;
             }
+            if (playRecord(_rec))
+                updCnt++;
+        }
+    } else {
+        //mandala data, only fields with samples due
+        while (!sched.empty()) {
+            const sched_s s = sched.top();
+            if (s.t > t) {
+                if (tNextMin == tNext || tNextMin > s.t)
+                    tNextMin = s.t;
+                break;
+            }
+            sched.pop();
+            stream_s &st = streams[s.i];
+            if (playValue(st.fact, st.pts->at(st.pos).y()))
+                updCnt++;
+            if (++st.pos < st.pts->size())
+                sched.push({static_cast<quint64>(st.pts->at(st.pos).x() * 1000.0), s.i});
         }
         //events
         const QStringList &n = events.names;
@@ -347,61 +560,38 @@ void TelemetryPlayer::next()
                 quint64 fieldID = r.at(n.indexOf("name")).toULongLong();
                 if (!fieldID)
                     continue;
-                MandalaFact *f = static_cast<MandalaFact *>(factByDBID.value(fieldID));
-                if (!f)
-                    continue;
-                if (f->setValue(sv))
+                if (playUplink(static_cast<MandalaFact *>(factByDBID.value(fieldID)), sv))
                     updCnt++;
-                const QString &s = f->mpath();
-                if (s.startsWith("cmd.rc."))
-                    continue;
-                if (s.startsWith("cmd.gimbal."))
-                    continue;
-                vehicle->message(QString("%1: %2 = %3").arg(">").arg(f->title()).arg(f->text()),
-                                 AppNotify::Important);
                 continue;
             }
             if (type == 2 || type == 3) {
-                const QString &evt = r.at(n.indexOf("name")).toString();
-                const QString &uid = r.at(n.indexOf("uid")).toString();
-                if (evt == "msg") {
-                    QString s = sv;
-                    QString sub;
-                    if (s.startsWith('[')) {
-                        s.remove(0, 1);
-                        sub = s.left(s.indexOf(']'));
-                        s.remove(0, sub.size() + 1);
-                    }
-                    vehicle->message(QString("<: %1").arg(s),
-                                     AppNotify::FromVehicle | AppNotify::Important,
-                                     sub);
-                    App::sound(sv);
-                    continue;
-                }
-                if (evt == "mission") {
-                    vehicle->f_mission->storage->loadMission(uid);
-                } else if (evt == "nodes") {
-                    vehicle->storage()->loadVehicleConfig(uid);
-                } else if (evt == "conf") {
-                    loadConfValue(uid, sv);
-                    QString fn = sv.left(sv.indexOf('='));
-                    if (sv.size() > (fn.size() + 32) || sv.contains('\n')) {
-                        sv = fn + "=<data>";
-                    }
-                } else if (evt == "serial") {
-                    qDebug() << evt << sv;
-                    continue;
-                }
-                AppNotify::NotifyFlags flags = AppNotify::Important;
-                if (type != 3)
-                    flags |= AppNotify::FromVehicle;
-                QString s = QString("%1: %2").arg(type == 3 ? ">" : "<").arg(evt);
-                if (!sv.isEmpty())
-                    s.append(QString(" (%1)").arg(sv));
-                vehicle->message(s, flags);
+                playEvent(r.at(n.indexOf("name")).toString(),
+                          sv,
+                          r.at(n.indexOf("uid")).toString(),
+                          type == 3);
                 continue;
             }
         }
+    }
+    return updCnt;
+}
+
+void TelemetryPlayer::next()
+{
+    if (!active())
+        return;
+    if (_fast) {
+        nextFast();
+        return;
+    }
+    quint64 t = playTime.elapsed();
+    if (_speed > 0 && _speed != 1.0)
+        t = t * _speed;
+    t += playTime0;
+
+    if (tNext <= t) {
+        quint64 tNextMin = tNext;
+        uint updCnt = replay(t, tNextMin);
 
         //update states
         if (_time != t) {
@@ -431,58 +621,37 @@ void TelemetryPlayer::next()
         next();
 }
 
-double TelemetryPlayer::sampleValue(quint64 fieldID, double t)
+void TelemetryPlayer::nextFast()
 {
-    dataPosMap[fieldID] = 0;
-    QVector<QPointF> *pts = telemetry->f_reader->fieldData.value(fieldID);
-    if (!pts)
-        return 0;
-
-    if (pts->size() < 50) {
-        for (int i = 0; i < pts->size(); ++i) {
-            if (pts->at(i).x() >= t) {
-                dataPosMap[fieldID] = i;
-                return pts->at(i).y();
-            }
+    //replay without pacing, yield to event loop after each time slice
+    QElapsedTimer slice;
+    slice.start();
+    bool finished = false;
+    while (slice.elapsed() < TELEMETRY_FAST_SLICE) {
+        quint64 tNextMin = tNext;
+        _fastUpdCnt += replay(tNext, tNextMin);
+        _time = tNext;
+        if (tNextMin == tNext) {
+            finished = true;
+            break;
         }
-        return 0;
+        tNext = tNextMin;
     }
-    int ts = pts->size() / 2;
-    int tx = ts;
-    bool bFound = false, bFwd = false;
-    while (1) {
-        const QPointF &p = pts->at(tx);
-        double vx = p.x();
-        ts >>= 1;
-        if (ts == 0) {
-            if (bFound) {
-                dataPosMap[fieldID] = tx;
-                return p.y();
-            }
-            ts = 1;
-        }
-        if (vx < t) {
-            tx += ts;
-            if (tx >= pts->size()) {
-                tx = pts->size() - 1;
-                if (ts == 1)
-                    bFound = true;
-            }
-            bFwd = true;
-        } else if (vx > t) {
-            if (ts == 1 && bFwd == true)
-                bFound = true;
-            if (tx > ts)
-                tx -= ts;
-            else {
-                tx = 0;
-                if (ts == 1)
-                    bFound = true;
-            }
-            bFwd = false;
-        } else {
-            dataPosMap[fieldID] = tx;
-            return p.y();
-        }
+
+    //batched notifications
+    blockTimeChange = true;
+    f_time->setValue(_time);
+    blockTimeChange = false;
+    if (_fastUpdCnt && (finished || !quiet())) {
+        flushQuiet();
+        _fastUpdCnt = 0;
+        vehicle->f_mandala->telemetryDecoded();
+    }
+
+    if (finished) {
+        apxMsg() << tr("Replay finished");
+        stop();
+        return;
     }
+    timer.start(0);
 }
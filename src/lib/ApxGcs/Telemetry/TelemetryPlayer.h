@@ -22,11 +22,14 @@
 #pragma once
 
 #include <Database/DatabaseRequest.h>
+#include <Database/TelemetryFileReader.h>
 #include <Fact/Fact.h>
 #include <QtCore>
+#include <queue>
 
 class Vehicle;
 class Telemetry;
+class MandalaFact;
 
 class TelemetryPlayer : public Fact
 {
@@ -38,6 +41,8 @@ public:
     Fact *f_filter;
     Fact *f_time;
     Fact *f_speed;
+    Fact *f_fast;
+    Fact *f_quiet;
 
     Fact *f_play;
     Fact *f_stop;
@@ -48,6 +53,7 @@ private:
     Vehicle *vehicle;
 
     quint64 cacheID;
+    TelemetryFileReader *_file{};
 
     QTimer timer;
     quint64 playTime0;
@@ -58,14 +64,50 @@ private:
     double _speed;
     double _time;
 
+    // headless replay without real time pacing
+    bool _fast{};
+    uint _fastUpdCnt{};
+    bool quiet() const;
+    void nextFast();
+    bool _quietPending{}; // values updated without notification
+    bool playValue(Fact *f, const QVariant &v); // no notifications in quiet mode
+    void flushQuiet();
+
     bool blockTimeChange;
 
     QHash<quint64, Fact *> factByDBID;
     DatabaseRequest::Records events;
     int iEventRec;
 
-    QHash<quint64, int> dataPosMap;
-    double sampleValue(quint64 fieldID, double t);
+    // fields replay scheduler, min-heap of fields next sample time
+    struct stream_s
+    {
+        const QVector<QPointF> *pts;
+        Fact *fact;
+        int pos;
+    };
+    struct sched_s
+    {
+        quint64 t;
+        int i;
+        bool operator>(const sched_s &other) const { return t > other.t; }
+    };
+    QVector<stream_s> streams;
+    std::priority_queue<sched_s, std::vector<sched_s>, std::greater<sched_s>> sched;
+    void seekStreams(quint64 t);
+
+    // replay data and events up to t, returns updated facts count
+    uint replay(quint64 t, quint64 &tNextMin);
+
+    // binary file stream
+    QVector<Fact *> factByVidx;
+    TelemetryFileReader::record_s _rec{};
+    bool _recPending{};
+    void playFile();
+    bool playRecord(const TelemetryFileReader::record_s &rec);
+
+    bool playUplink(MandalaFact *f, const QVariant &v);
+    void playEvent(const QString &evt, QString sv, const QString &uid, bool uplink);
 
     void loadConfValue(const QString &sn, QString s);
 
@@ -62,6 +62,7 @@ TelemetryReader::TelemetryReader(LookupTelemetry *lookup, Fact *parent)
     qRegisterMetaType<times_t>("times_t");
     qRegisterMetaType<events_t>("events_t");
     qRegisterMetaType<FactList>("FactList");
+    qRegisterMetaType<TelemetryFileReader *>("TelemetryFileReader*");
 
     connect(lookup, &LookupTelemetry::recordTriggered, this, &TelemetryReader::load);
 
@@ -73,6 +74,11 @@ TelemetryReader::TelemetryReader(LookupTelemetry *lookup, Fact *parent)
     updateRecordInfo();
 }
 
+TelemetryReader::~TelemetryReader()
+{
+    delete file;
+}
+
 void TelemetryReader::updateStatus()
 {
     const QString &s = AppRoot::timeToString(totalTime() / 1000, true);
@@ -137,7 +143,31 @@ void TelemetryReader::load()
     setTotalTime(0);
     setProgress(0);
     deleteChildren();
-    DBReqTelemetryFindCache *req = new DBReqTelemetryFindCache(key);
+    DBReqTelemetryFindFile *req = new DBReqTelemetryFindFile(key);
+    connect(req,
+            &DBReqTelemetryFindFile::fileFound,
+            this,
+            &TelemetryReader::dbFileFound,
+            Qt::QueuedConnection);
+    connect(req,
+            &DBReqTelemetryFindFile::fileNotFound,
+            this,
+            &TelemetryReader::dbFileNotFound,
+            Qt::QueuedConnection);
+    req->exec();
+}
+
+void TelemetryReader::dbFileFound(quint64 telemetryID, QString fileName)
+{
+    if (telemetryID != lookup->recordId())
+        return;
+    dbReadData(telemetryID, fileName);
+}
+void TelemetryReader::dbFileNotFound(quint64 telemetryID)
+{
+    if (telemetryID != lookup->recordId())
+        return;
+    DBReqTelemetryFindCache *req = new DBReqTelemetryFindCache(telemetryID);
     connect(req,
             &DBReqTelemetryFindCache::cacheFound,
             this,
@@ -205,7 +235,11 @@ void TelemetryReader::dbStatsFound(quint64 telemetryID, QVariantMap stats)
     Q_UNUSED(stats)
     if (telemetryID != lookup->recordId())
         return;
-    TelemetryReaderDataReq *req = new TelemetryReaderDataReq(telemetryID);
+    dbReadData(telemetryID, QString());
+}
+void TelemetryReader::dbReadData(quint64 telemetryID, QString fileName)
+{
+    TelemetryReaderDataReq *req = new TelemetryReaderDataReq(telemetryID, fileName);
     connect(lookup,
             &LookupTelemetry::discardRequests,
             req,
@@ -216,6 +250,11 @@ void TelemetryReader::dbStatsFound(quint64 telemetryID, QVariantMap stats)
             this,
             &TelemetryReader::dbResultsDataProc,
             Qt::QueuedConnection);
+    connect(req,
+            &TelemetryReaderDataReq::statsProcessed,
+            this,
+            &TelemetryReader::dbFileStats,
+            Qt::QueuedConnection);
     connect(req,
             &DBReqTelemetryReadData::progress,
             this,
@@ -238,6 +277,21 @@ void TelemetryReader::dbStatsUpdated(quint64 telemetryID, QVariantMap stats)
     updateRecordInfo();
     dbStatsFound(telemetryID, stats);
 }
+void TelemetryReader::dbFileStats(quint64 telemetryID, QVariantMap stats)
+{
+    if (telemetryID != lookup->recordId())
+        return;
+    QVariantMap info = lookup->recordInfo();
+    foreach (QString key, stats.keys()) {
+        info[key] = stats.value(key);
+    }
+    lookup->setRecordInfo(info);
+    updateRecordInfo();
+
+    // file records skip cache and stats requests, keep the database record up to date
+    DBReqTelemetryWriteInfo *req = new DBReqTelemetryWriteInfo(telemetryID, stats);
+    req->exec();
+}
 void TelemetryReader::dbResultsDataProc(quint64 telemetryID,
                                         quint64 cacheID,
                                         fieldData_t fieldData,
@@ -245,14 +299,22 @@ void TelemetryReader::dbResultsDataProc(quint64 telemetryID,
                                         times_t times,
                                         events_t events,
                                         QGeoPath path,
-                                        Fact *f_events)
+                                        Fact *f_events,
+                                        TelemetryFileReader *file)
 {
-    if (telemetryID != lookup->recordId())
+    if (telemetryID != lookup->recordId()) {
+        delete file;
         return;
+    }
 
     deleteChildren();
     f_reload->setEnabled(true);
 
+    delete this->file;
+    this->file = file;
+    if (file)
+        setTotalSize(file->valuesCount() + file->eventsCount());
+
     times.swap(this->times);
     fieldNames.swap(this->fieldNames);
     fieldData.swap(this->fieldData);
@@ -23,6 +23,7 @@
 
 #include <ApxMisc/DelayedEvent.h>
 #include <Database/DatabaseRequest.h>
+#include <Database/TelemetryFileReader.h>
 #include <Fact/Fact.h>
 #include <QGeoPath>
 #include <QtCore>
@@ -38,6 +39,7 @@ class TelemetryReader : public Fact
 
 public:
     explicit TelemetryReader(LookupTelemetry *lookup, Fact *parent);
+    ~TelemetryReader();
 
     LookupTelemetry *lookup;
 
@@ -59,6 +61,9 @@ public:
     events_t events;
     QGeoPath geoPath;
 
+    // binary data file of the record when available
+    TelemetryFileReader *file{};
+
 private:
     bool blockNotesChange;
     DelayedEvent loadEvent;
@@ -75,7 +80,10 @@ private slots:
     //Database
 private slots:
     void dbLoadData();
+    void dbReadData(quint64 telemetryID, QString fileName);
 
+    void dbFileFound(quint64 telemetryID, QString fileName);
+    void dbFileNotFound(quint64 telemetryID);
     void dbCacheFound(quint64 telemetryID);
     void dbCacheNotFound(quint64 telemetryID);
 
@@ -86,10 +94,12 @@ private slots:
                            times_t times,
                            events_t events,
                            QGeoPath path,
-                           Fact *f_events);
+                           Fact *f_events,
+                           TelemetryFileReader *file);
 
     void dbStatsFound(quint64 telemetryID, QVariantMap stats);
     void dbStatsUpdated(quint64 telemetryID, QVariantMap stats);
+    void dbFileStats(quint64 telemetryID, QVariantMap stats);
     void dbProgress(quint64 telemetryID, int v);
 
     void reloadTriggered();
@@ -20,182 +20,605 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TelemetryReaderDataReq.h"
+
+#include <Database/Database.h>
+#include <Database/TelemetryFileReader.h>
 #include <Fact/Fact.h>
 
+#include <QtConcurrent>
+
+// columnar cache file signature and format version
+#define TELEMETRY_COLUMNS_MAGIC 0x41505801
+
 bool TelemetryReaderDataReq::run(QSqlQuery &query)
 {
-    if (!DBReqTelemetryReadData::run(query))
+    if (_fileName.isEmpty())
+        return readCache(query);
+    return readFile(query);
+}
+
+bool TelemetryReaderDataReq::readCache(QSqlQuery &query)
+{
+    //try columnar cache first
+    query.prepare("SELECT Telemetry.hash, TelemetryCache.key FROM Telemetry"
+                  " INNER JOIN TelemetryCache ON TelemetryCache.telemetryID=Telemetry.key"
+                  " WHERE Telemetry.key=?");
+    query.addBindValue(telemetryID);
+    if (!query.exec())
         return false;
-    if (discarded())
-        return true;
+    QString hash;
+    if (query.next()) {
+        hash = query.value(0).toString();
+        cacheID = query.value(1).toULongLong();
+        if (!hash.isEmpty() && loadColumns(hash)) {
+            if (discarded())
+                return true;
+            emit dataProcessed(telemetryID,
+                               cacheID,
+                               _fieldData,
+                               fieldNames,
+                               _times,
+                               _events,
+                               _path,
+                               f_events,
+                               nullptr);
+            return true;
+        }
+        resetData();
+    }
+    cacheID = 0;
 
-    int iTime = records.names.indexOf("time");
-    int iType = records.names.indexOf("type");
-    int iName = records.names.indexOf("name");
-    int iValue = records.names.indexOf("value");
-    int iUid = records.names.indexOf("uid");
+    emit progress(telemetryID, 0);
 
-    QGeoPath path;
-    quint64 fidLat = fieldNames.key("est.pos.lat");
-    quint64 fidLon = fieldNames.key("est.pos.lon");
-    quint64 fidHmsl = fieldNames.key("est.pos.hmsl");
-    QVector<QPointF> *vLat = nullptr;
-    QVector<QPointF> *vLon = nullptr;
-    QVector<QPointF> *vHmsl = nullptr;
+    query.prepare("SELECT * FROM TelemetryCache WHERE telemetryID=?");
+    query.addBindValue(telemetryID);
+    if (!query.exec())
+        return false;
+    if (!query.next())
+        return false;
+    cacheID = query.value(0).toULongLong();
+    const quint64 count = query.value("records").toULongLong();
 
-    fieldData_t fieldData;
-    times_t times;
-    events_t events;
+    //per field samples count to size buffers
+    query.prepare("SELECT name, COUNT(*) FROM TelemetryCacheData"
+                  " WHERE cacheID=? AND (type IS NULL OR type<=1)"
+                  " GROUP BY name");
+    query.addBindValue(cacheID);
+    if (!query.exec())
+        return false;
+    while (query.next())
+        _fieldCounts.insert(query.value(0).toULongLong(), query.value(1).toULongLong());
 
-    times.append(0);
+    //collect used fields names
+    query.prepare("SELECT key, name FROM TelemetryFields");
+    if (!query.exec())
+        return false;
+    while (query.next()) {
+        quint64 fid = query.value(0).toULongLong();
+        if (_fieldCounts.contains(fid))
+            fieldNames.insert(fid, query.value(1).toString());
+    }
+    if (discarded())
+        return true;
 
+    //stream data rows
+    query.prepare("SELECT time,type,name,value,uid FROM TelemetryCacheData"
+                  " WHERE cacheID=?"
+                  " ORDER BY time,type,name");
+    query.addBindValue(cacheID);
+    if (!query.exec())
+        return false;
+
+    initData();
+
+    quint64 row = 0;
     quint64 t0 = 0;
-    QHash<quint64, double> fvalues;
     int progress_s = 0;
 
-    f_events = new Fact(nullptr,
-                        "events",
-                        tr("Events"),
-                        tr("Recorded events data"),
-                        Fact::Group | Fact::Count);
-    f_events->moveToThread(nullptr);
-
-    for (int i = 0; i < records.values.size(); ++i) {
+    while (query.next()) {
         if (discarded())
             return true;
 
-        const QVariantList &r = records.values.at(i);
-        if (r.isEmpty())
-            continue;
-
         //progress and abort
-        int vp = i * 100 / records.values.size();
+        int vp = count > 0 ? static_cast<int>(row * 100 / count) : 0;
         if (progress_s != vp) {
             progress_s = vp;
             emit progress(telemetryID, vp);
         }
 
         //time
-        quint64 t = r.at(iTime).toULongLong();
-        if (i == 0)
+        quint64 t = query.value(0).toULongLong();
+        if (row++ == 0)
             t0 = t;
         t -= t0;
-        double tf = t / 1000.0;
-        if (times.last() != tf)
-            times.append(tf);
-
-        quint64 fid = 0;
+        addTime(t);
 
-        switch (r.at(iType).toUInt()) {
+        switch (query.value(1).toUInt()) {
         case 0: {
             //downlink data
-            fid = r.at(iName).toULongLong();
+            addValue(t, query.value(2).toULongLong(), query.value(3).toDouble());
         } break;
         case 1: {
             //uplink data
-            fid = r.at(iName).toULongLong();
-            event_t e;
-            e.time = t;
-            e.name = "uplink";
-            e.value = fieldNames.value(fid, QString::number(fid));
-            e.uid = r.at(iUid).toString();
-            events.append(e);
-            addEventFact(e.time, e.name, e.value, e.uid);
+            quint64 fid = query.value(2).toULongLong();
+            addEvent(t,
+                     "uplink",
+                     fieldNames.value(fid, QString::number(fid)),
+                     query.value(4).toString());
+            addValue(t, fid, query.value(3).toDouble());
         } break;
         case 2:
         case 3: {
             //events
-            event_t e;
-            e.time = t;
-            e.name = r.at(iName).toString();
-            e.value = r.at(iValue).toString();
-            e.uid = r.at(iUid).toString();
-            events.append(e);
-            addEventFact(e.time, e.name, e.value, e.uid);
+            addEvent(t,
+                     query.value(2).toString(),
+                     query.value(3).toString(),
+                     query.value(4).toString());
         } break;
         }
+    }
+    finishData();
 
-        if (!fid)
-            continue;
-        QVector<QPointF> *pts = fieldData.value(fid);
-        if (!pts) {
-            pts = new QVector<QPointF>;
-            pts->reserve(1000000);
-            fieldData.insert(fid, pts);
-        }
-        double v = r.at(iValue).toDouble();
-        if (fvalues.contains(fid) && fvalues.value(fid) == v)
-            continue;
-        fvalues[fid] = v;
+    if (discarded())
+        return true;
 
-        if (pts->size() > 0 && (tf - pts->last().x()) > 0.5) {
-            //extrapolate unchanged value tail-1ms
-            pts->append(QPointF(tf, pts->last().y()));
+    if (!hash.isEmpty())
+        saveColumns(hash);
+
+    emit dataProcessed(telemetryID,
+                       cacheID,
+                       _fieldData,
+                       fieldNames,
+                       _times,
+                       _events,
+                       _path,
+                       f_events,
+                       nullptr);
+
+    return true;
+}
+
+bool TelemetryReaderDataReq::readFile(QSqlQuery &query)
+{
+    emit progress(telemetryID, 0);
+
+    query.prepare("SELECT * FROM Telemetry WHERE key=?");
+    query.addBindValue(telemetryID);
+    if (!query.exec())
+        return false;
+    if (!query.next())
+        return false;
+    info = filterIdValues(queryRecord(query));
+
+    TelemetryFileReader *file = new TelemetryFileReader();
+    if (!file->open(_fileName)) {
+        delete file;
+        return false;
+    }
+
+    // map file fields to database fields
+    TelemetryDB *db = Database::instance()->telemetry;
+    QVector<quint64> fids;
+    for (auto const &name : file->fields())
+        fids.append(db->field_key(name));
+    for (int i = 0; i < file->fieldCounts().size(); ++i)
+        _fieldCounts[fids.value(i)] += file->fieldCounts().at(i);
+
+    // cache of the same record when data rows are available too
+    query.prepare("SELECT key FROM TelemetryCache WHERE telemetryID=?");
+    query.addBindValue(telemetryID);
+    if (!query.exec())
+        return false;
+    cacheID = query.next() ? query.value(0).toULongLong() : 0;
+
+    initData();
+
+    QSet<quint64> usedFields;
+    int progress_s = 0;
+    TelemetryFileReader::record_s rec{};
+
+    // record stats, same as collected by DBReqTelemetryMakeStats
+    quint64 downlink = 0;
+    quint64 uplink = 0;
+    QMap<QString, quint64> evtCount;
+
+    while (file->next(&rec)) {
+        if (discarded()) {
+            delete file;
+            return true;
         }
-        if (pts->isEmpty() && v != 0.0 && t != 0) {
-            //extrapolate/predict initial value at start
-            pts->append(QPointF(0, 0));
-            pts->append(QPointF(tf, 0));
+
+        //progress and abort
+        int vp = static_cast<int>(static_cast<quint64>(rec.pos) * 100 / file->size());
+        if (progress_s != vp) {
+            progress_s = vp;
+            emit progress(telemetryID, vp);
         }
-        pts->append(QPointF(tf, v));
-
-        //path update
-        while (fid && (fid == fidLat || fid == fidLon || fid == fidHmsl)) {
-            if (!vLat)
-                vLat = fieldData.value(fidLat);
-            if (!vLon)
-                vLon = fieldData.value(fidLon);
-            if (!vHmsl)
-                vHmsl = fieldData.value(fidHmsl);
-
-            if (!(vLat && vLon && vHmsl))
-                break;
 
-            QGeoCoordinate c(vLat->last().y(), vLon->last().y(), vHmsl->last().y());
+        const quint64 t = rec.ts;
+        addTime(t);
 
-            if (!c.isValid())
+        switch (rec.type) {
+        default:
+            break;
+        case TelemetryFileReader::rec_e::value: {
+            //downlink data
+            if (rec.null)
                 break;
-            if (c.latitude() == 0.0)
+            downlink++;
+            quint64 fid = fids.value(static_cast<int>(rec.vidx));
+            if (!fid)
                 break;
-            if (c.longitude() == 0.0)
+            usedFields.insert(fid);
+            addValue(t, fid, rec.value);
+        } break;
+        case TelemetryFileReader::rec_e::uplink: {
+            //uplink data
+            uplink++;
+            const int vidx = static_cast<int>(rec.vidx);
+            addEvent(t, "uplink", file->fields().at(vidx), QString());
+            quint64 fid = fids.value(vidx);
+            if (!fid || rec.null)
                 break;
-            qreal dist = 0;
-            if (!path.isEmpty()) {
-                QGeoCoordinate c0(path.path().last());
-                if (c0.latitude() == c.latitude())
-                    break;
-                if (c0.longitude() == c.longitude())
-                    break;
-                dist = c0.distanceTo(c);
-                if (dist < 10.0)
-                    break;
-            }
-            path.addCoordinate(c);
-            break;
+            usedFields.insert(fid);
+            addValue(t, fid, rec.value);
+        } break;
+        case TelemetryFileReader::rec_e::evt: {
+            evtCount[rec.name]++;
+            addEvent(t, rec.name, rec.text, rec.uid);
+        } break;
+        case TelemetryFileReader::rec_e::msg: {
+            evtCount[rec.name]++;
+            addEvent(t, rec.name, rec.text, rec.uid);
+        } break;
         }
     }
+    finishData();
+    file->seek(0);
 
-    //final data tail at max time
-    qreal tMax = times.isEmpty() ? 0 : times.last();
-    for (int i = 0; i < fieldData.values().size(); ++i) {
-        QVector<QPointF> *pts = fieldData.values().at(i);
-        if (!pts)
+    if (discarded()) {
+        delete file;
+        return true;
+    }
+
+    for (int i = 0; i < fids.size(); ++i) {
+        quint64 fid = fids.at(i);
+        if (usedFields.contains(fid))
+            fieldNames.insert(fid, file->fields().at(i));
+    }
+
+    quint64 events = 0;
+    QStringList st;
+    for (auto i = evtCount.begin(); i != evtCount.end(); ++i) {
+        events += i.value();
+        st.append(QString("%1=%2").arg(i.key()).arg(i.value()));
+    }
+    QVariantMap stats;
+    stats["totalTime"] = static_cast<quint64>(file->duration());
+    stats["downlink"] = downlink;
+    stats["uplink"] = uplink;
+    stats["events"] = events;
+    stats["evtDetails"] = st.join(',');
+    for (auto const &key : stats.keys()) {
+        if (info.value(key).toString() == stats.value(key).toString())
             continue;
-        if (pts->isEmpty()) {
-            pts->append(QPointF(0, 0));
-            //continue;
+        emit statsProcessed(telemetryID, stats);
+        break;
+    }
+
+    emit dataProcessed(telemetryID,
+                       cacheID,
+                       _fieldData,
+                       fieldNames,
+                       _times,
+                       _events,
+                       _path,
+                       f_events,
+                       file);
+
+    return true;
+}
+
+template<typename T>
+static QByteArray packColumn(const QVector<T> &v)
+{
+    return qCompress(QByteArray::fromRawData(reinterpret_cast<const char *>(v.constData()),
+                                             v.size() * static_cast<int>(sizeof(T))));
+}
+template<typename T>
+static bool unpackColumn(const QByteArray &data, QVector<T> *v)
+{
+    const QByteArray ba = qUncompress(data);
+    if (ba.size() % static_cast<int>(sizeof(T)))
+        return false;
+    v->resize(ba.size() / static_cast<int>(sizeof(T)));
+    memcpy(v->data(), ba.constData(), static_cast<size_t>(ba.size()));
+    return true;
+}
+
+bool TelemetryReaderDataReq::loadColumns(const QString &hash)
+{
+    QFile file(TelemetryDB::cacheDir().absoluteFilePath(QString::number(telemetryID)));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream ds(&file);
+    quint32 magic;
+    QString s;
+    ds >> magic >> s;
+    if (magic != TELEMETRY_COLUMNS_MAGIC || s != hash)
+        return false;
+
+    initData();
+
+    QByteArray ba;
+    ds >> ba;
+    if (!unpackColumn(ba, &_times))
+        return false;
+
+    //fields data [time, value]
+    quint32 cnt;
+    ds >> cnt;
+    QVector<double> vx, vy;
+    for (quint32 i = 0; i < cnt; ++i) {
+        if (discarded())
+            return false;
+        quint64 fid;
+        QByteArray bx, by;
+        ds >> fid >> s >> bx >> by;
+        if (ds.status() != QDataStream::Ok)
+            return false;
+        if (!unpackColumn(bx, &vx) || !unpackColumn(by, &vy) || vx.size() != vy.size())
+            return false;
+        auto pts = new QVector<QPointF>(vx.size());
+        for (int j = 0; j < vx.size(); ++j)
+            (*pts)[j] = QPointF(vx.at(j), vy.at(j));
+        _fieldData.insert(fid, pts);
+        fieldNames.insert(fid, s);
+    }
+
+    //events
+    ds >> cnt;
+    for (quint32 i = 0; i < cnt; ++i) {
+        quint64 t;
+        QString name, value, uid;
+        ds >> t >> name >> value >> uid;
+        if (ds.status() != QDataStream::Ok)
+            return false;
+        addEvent(t, name, value, uid);
+    }
+
+    //path [lat, lon, hmsl]
+    ds >> ba;
+    QVector<double> vp;
+    if (!unpackColumn(ba, &vp) || vp.size() % 3)
+        return false;
+    for (int i = 0; i < vp.size(); i += 3)
+        _path.addCoordinate(QGeoCoordinate(vp.at(i), vp.at(i + 1), vp.at(i + 2)));
+
+    return ds.status() == QDataStream::Ok;
+}
+
+void TelemetryReaderDataReq::saveColumns(const QString &hash)
+{
+    QDir dir(TelemetryDB::cacheDir());
+    if (!dir.exists())
+        dir.mkpath(".");
+    QSaveFile file(dir.absoluteFilePath(QString::number(telemetryID)));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << file.errorString() << file.fileName();
+        return;
+    }
+
+    QDataStream ds(&file);
+    ds << static_cast<quint32>(TELEMETRY_COLUMNS_MAGIC) << hash;
+    ds << packColumn(_times);
+
+    //fields data [time, value]
+    ds << static_cast<quint32>(_fieldData.size());
+    QVector<double> vx, vy;
+    for (auto i = _fieldData.begin(); i != _fieldData.end(); ++i) {
+        const QVector<QPointF> *pts = i.value();
+        vx.resize(pts->size());
+        vy.resize(pts->size());
+        for (int j = 0; j < pts->size(); ++j) {
+            vx[j] = pts->at(j).x();
+            vy[j] = pts->at(j).y();
         }
-        if (pts->last().x() >= tMax)
+        ds << i.key() << fieldNames.value(i.key()) << packColumn(vx) << packColumn(vy);
+    }
+
+    //events
+    ds << static_cast<quint32>(_events.size());
+    for (auto const &e : _events)
+        ds << e.time << e.name << e.value << e.uid;
+
+    //path [lat, lon, hmsl]
+    QVector<double> vp;
+    vp.reserve(_path.path().size() * 3);
+    for (auto const &c : _path.path())
+        vp << c.latitude() << c.longitude() << c.altitude();
+    ds << packColumn(vp);
+
+    if (ds.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return;
+    }
+    file.commit();
+}
+
+void TelemetryReaderDataReq::initData()
+{
+    if (_fileName.isEmpty()) {
+        _fidLat = fieldNames.key("est.pos.lat");
+        _fidLon = fieldNames.key("est.pos.lon");
+        _fidHmsl = fieldNames.key("est.pos.hmsl");
+    } else {
+        TelemetryDB *db = Database::instance()->telemetry;
+        _fidLat = db->field_key(QString("est.pos.lat"));
+        _fidLon = db->field_key(QString("est.pos.lon"));
+        _fidHmsl = db->field_key(QString("est.pos.hmsl"));
+    }
+
+    _times.append(0);
+
+    f_events = new Fact(nullptr,
+                        "events",
+                        tr("Events"),
+                        tr("Recorded events data"),
+                        Fact::Group | Fact::Count);
+    f_events->moveToThread(nullptr);
+}
+
+void TelemetryReaderDataReq::resetData()
+{
+    qDeleteAll(_fieldData);
+    _fieldData.clear();
+    fieldNames.clear();
+    _times.clear();
+    _events.clear();
+    _path = QGeoPath();
+    _fieldCounts.clear();
+    delete f_events;
+    f_events = nullptr;
+}
+
+void TelemetryReaderDataReq::addTime(quint64 t)
+{
+    double tf = t / 1000.0;
+    if (_times.last() != tf)
+        _times.append(tf);
+}
+
+void TelemetryReaderDataReq::addEvent(quint64 t,
+                                      const QString &name,
+                                      const QString &value,
+                                      const QString &uid)
+{
+    event_t e;
+    e.time = t;
+    e.name = name;
+    e.value = value;
+    e.uid = uid;
+    _events.append(e);
+    addEventFact(e.time, e.name, e.value, e.uid);
+}
+
+void TelemetryReaderDataReq::addValue(quint64 t, quint64 fid, double v)
+{
+    if (!fid)
+        return;
+    QVector<QPointF> *pts = _fieldData.value(fid);
+    if (!pts) {
+        pts = new QVector<QPointF>;
+        //samples count with initial and tail points
+        pts->reserve(static_cast<int>(_fieldCounts.value(fid)) + 3);
+        _fieldData.insert(fid, pts);
+    }
+    //raw samples, processed in finishData
+    pts->append(QPointF(t / 1000.0, v));
+}
+
+void TelemetryReaderDataReq::finishData()
+{
+    qreal tMax = _times.isEmpty() ? 0 : _times.last();
+
+    //path from raw position samples
+    QFuture<void> fpath = QtConcurrent::run(this,
+                                            &TelemetryReaderDataReq::updatePath,
+                                            fieldSamples(_fidLat),
+                                            fieldSamples(_fidLon),
+                                            fieldSamples(_fidHmsl));
+
+    //fields are independent
+    QList<QVector<QPointF> *> list = _fieldData.values();
+    QtConcurrent::blockingMap(list, [tMax](QVector<QPointF> *pts) { processField(pts, tMax); });
+
+    fpath.waitForFinished();
+}
+
+QVector<QPointF> TelemetryReaderDataReq::fieldSamples(quint64 fid) const
+{
+    const QVector<QPointF> *pts = _fieldData.value(fid);
+    return pts ? *pts : QVector<QPointF>();
+}
+
+void TelemetryReaderDataReq::processField(QVector<QPointF> *pts, qreal tMax)
+{
+    QVector<QPointF> d;
+    d.reserve(pts->size() + 3);
+    for (auto const &p : *pts) {
+        const double tf = p.x();
+        const double v = p.y();
+        if (!d.isEmpty() && d.last().y() == v)
             continue;
-        pts->append(QPointF(tMax, pts->last().y()));
+
+        if (d.size() > 0 && (tf - d.last().x()) > 0.5) {
+            //extrapolate unchanged value tail-1ms
+            d.append(QPointF(tf, d.last().y()));
+        }
+        if (d.isEmpty() && v != 0.0 && tf != 0.0) {
+            //extrapolate/predict initial value at start
+            d.append(QPointF(0, 0));
+            d.append(QPointF(tf, 0));
+        }
+        d.append(QPointF(tf, v));
     }
 
-    if (discarded())
-        return true;
+    //final data tail at max time
+    if (d.isEmpty())
+        d.append(QPointF(0, 0));
+    if (d.last().x() < tMax)
+        d.append(QPointF(tMax, d.last().y()));
 
-    emit dataProcessed(telemetryID, cacheID, fieldData, fieldNames, times, events, path, f_events);
+    pts->swap(d);
+}
 
-    return true;
+void TelemetryReaderDataReq::updatePath(QVector<QPointF> lat,
+                                        QVector<QPointF> lon,
+                                        QVector<QPointF> hmsl)
+{
+    if (lat.isEmpty() || lon.isEmpty() || hmsl.isEmpty())
+        return;
+
+    //merge samples by time and track the latest position
+    int iLat = 0, iLon = 0, iHmsl = 0;
+    QGeoCoordinate c(qQNaN(), qQNaN(), qQNaN());
+    while (iLat < lat.size() || iLon < lon.size() || iHmsl < hmsl.size()) {
+        qreal t = std::numeric_limits<qreal>::max();
+        if (iLat < lat.size())
+            t = qMin(t, lat.at(iLat).x());
+        if (iLon < lon.size())
+            t = qMin(t, lon.at(iLon).x());
+        if (iHmsl < hmsl.size())
+            t = qMin(t, hmsl.at(iHmsl).x());
+
+        if (iLat < lat.size() && lat.at(iLat).x() == t)
+            c.setLatitude(lat.at(iLat++).y());
+        else if (iLon < lon.size() && lon.at(iLon).x() == t)
+            c.setLongitude(lon.at(iLon++).y());
+        else if (iHmsl < hmsl.size() && hmsl.at(iHmsl).x() == t)
+            c.setAltitude(hmsl.at(iHmsl++).y());
+
+        if (qIsNaN(c.latitude()) || qIsNaN(c.longitude()) || qIsNaN(c.altitude()))
+            continue;
+        if (!c.isValid())
+            continue;
+        if (c.latitude() == 0.0)
+            continue;
+        if (c.longitude() == 0.0)
+            continue;
+        if (!_path.isEmpty()) {
+            QGeoCoordinate c0(_path.path().last());
+            if (c0.latitude() == c.latitude())
+                continue;
+            if (c0.longitude() == c.longitude())
+                continue;
+            if (c0.distanceTo(c) < 10.0)
+                continue;
+        }
+        _path.addCoordinate(c);
+    }
 }
 
 void TelemetryReaderDataReq::addEventFact(quint64 time,
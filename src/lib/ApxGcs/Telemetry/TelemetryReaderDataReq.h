@@ -25,12 +25,15 @@
 #include <Fact/Fact.h>
 #include <QGeoPath>
 
+class TelemetryFileReader;
+
 class TelemetryReaderDataReq : public DBReqTelemetryReadData
 {
     Q_OBJECT
 public:
-    explicit TelemetryReaderDataReq(quint64 tID)
+    explicit TelemetryReaderDataReq(quint64 tID, QString fileName = QString())
         : DBReqTelemetryReadData(tID)
+        , _fileName(fileName)
     {}
     //types
     typedef QHash<quint64, QVector<QPointF> *> fieldData_t;
@@ -50,10 +53,43 @@ protected:
     bool run(QSqlQuery &query);
 
 private:
-    Fact *f_events;
+    QString _fileName;
+
+    bool readCache(QSqlQuery &query);
+    bool readFile(QSqlQuery &query);
+
+    // columnar cache file, valid for record data hash
+    bool loadColumns(const QString &hash);
+    void saveColumns(const QString &hash);
+
+    // data processing
+    fieldData_t _fieldData;
+    times_t _times;
+    events_t _events;
+    QGeoPath _path;
+
+    QHash<quint64, quint64> _fieldCounts;
+    quint64 _fidLat{}, _fidLon{}, _fidHmsl{};
+
+    void initData();
+    void resetData();
+    void addTime(quint64 t);
+    void addValue(quint64 t, quint64 fid, double v);
+    void addEvent(quint64 t, const QString &name, const QString &value, const QString &uid);
+    void finishData();
+
+    // post processing, runs in thread pool
+    QVector<QPointF> fieldSamples(quint64 fid) const;
+    static void processField(QVector<QPointF> *pts, qreal tMax);
+    void updatePath(QVector<QPointF> lat, QVector<QPointF> lon, QVector<QPointF> hmsl);
+
+    Fact *f_events{};
     void addEventFact(quint64 time, const QString &name, const QString &value, const QString &uid);
 
 signals:
+    // stats of file records, emitted when differ from the database record
+    void statsProcessed(quint64 telemetryID, QVariantMap stats);
+
     void dataProcessed(quint64 telemetryID,
                        quint64 cacheID,
                        fieldData_t fieldData,
@@ -61,5 +97,6 @@ signals:
                        times_t times,
                        events_t events,
                        QGeoPath path,
-                       Fact *f_events);
+                       Fact *f_events,
+                       TelemetryFileReader *file);
 };
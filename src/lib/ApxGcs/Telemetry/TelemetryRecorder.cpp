@@ -30,6 +30,11 @@
 
 #include <Nodes/Nodes.h>
 
+// data frames coalescing window [ms]
+#define TELEMETRY_BATCH_INTERVAL 500
+// max rows per batch request
+#define TELEMETRY_BATCH_SIZE 10000
+
 TelemetryRecorder::TelemetryRecorder(Vehicle *vehicle, Fact *parent)
     : Fact(parent, "recorder", tr("Recorder"), tr("Telemetry recording"))
     , _vehicle(vehicle)
@@ -99,6 +104,10 @@ TelemetryRecorder::TelemetryRecorder(Vehicle *vehicle, Fact *parent)
     timeUpdateTimer.setInterval(500);
     connect(&timeUpdateTimer, &QTimer::timeout, this, &TelemetryRecorder::timeUpdate);
 
+    batchTimer.setSingleShot(true);
+    batchTimer.setInterval(TELEMETRY_BATCH_INTERVAL);
+    connect(&batchTimer, &QTimer::timeout, this, &TelemetryRecorder::dbFlushData);
+
     // auto recorder
     flightState_s = Vehicle::FS_UNKNOWN;
     recStopTimer.setSingleShot(true);
@@ -123,13 +132,6 @@ void TelemetryRecorder::restartRecording()
     reset();
 }
 
-void TelemetryRecorder::invalidateCache()
-{
-    if (!recTelemetryID)
-        return;
-    Database::instance()->telemetry->markCacheInvalid(recTelemetryID);
-}
-
 bool TelemetryRecorder::dbCheckRecord()
 {
     checkAutoRecord();
@@ -164,7 +166,10 @@ bool TelemetryRecorder::dbCheckRecord()
             // qDebug() << f->mpath() << f->value();
         }
         _values = values;
-        reqPendingList.append(new DBReqTelemetryWriteData(0, 0, _values, false));
+        if (_file.create(_vehicle))
+            _file.write_values(0, _values, false);
+        else
+            reqPendingList.append(new DBReqTelemetryWriteData(0, 0, _values, false));
 
         apxConsole() << tr("Telemetry record request");
         reqNewRecord->exec();
@@ -198,6 +203,14 @@ void TelemetryRecorder::dbRecordCreated(quint64 telemetryID)
     }
     reqPendingList.clear();
 
+    //link binary data file
+    if (_file.isOpen()) {
+        QVariantMap info;
+        info.insert("file", QFileInfo(_file.fileName()).fileName());
+        auto req = new DBReqTelemetryWriteInfo(telemetryID, info);
+        req->exec();
+    }
+
     //record shared info
     QVariantMap info;
     info["machineUID"] = App::machineUID();
@@ -208,24 +221,39 @@ void TelemetryRecorder::dbRecordCreated(quint64 telemetryID)
 }
 void TelemetryRecorder::cleanupValues(PBase::Values *values)
 {
-    for (auto uid : values->keys()) {
-        auto v = values->value(uid);
-        if (_values.value(uid) == v) {
-            values->remove(uid);
-        } else {
-            _values.insert(uid, v);
-        }
-    }
+    values->removeIf([this](const PBase::Values::value_s &v) { return !_values.update(v); });
 }
 void TelemetryRecorder::dbWriteRequest(DBReqTelemetryWriteBase *req)
 {
     if (recTelemetryID) {
+        req->telemetryID = recTelemetryID;
         req->exec();
-        invalidateCache();
     } else {
         reqPendingList.append(req);
     }
 }
+void TelemetryRecorder::dbWriteData(quint64 t, const PBase::Values &values, bool uplink)
+{
+    // records with binary file keep data there, the cache is made of the file
+    if (_file.isOpen())
+        return;
+    if (!reqBatch) {
+        reqBatch = new DBReqTelemetryWriteBatch(recTelemetryID);
+        batchTimer.start();
+    }
+    reqBatch->append(t, values, uplink);
+    if (reqBatch->size() >= TELEMETRY_BATCH_SIZE)
+        dbFlushData();
+}
+void TelemetryRecorder::dbFlushData()
+{
+    batchTimer.stop();
+    if (!reqBatch)
+        return;
+    auto req = reqBatch;
+    reqBatch = nullptr;
+    dbWriteRequest(req);
+}
 quint64 TelemetryRecorder::getEventTimestamp()
 {
     if (!_tsElapsed.isValid()) {
@@ -270,7 +298,8 @@ void TelemetryRecorder::recordTelemetry(PBase::Values values, quint64 timestamp_
     if (values.isEmpty())
         return;
 
-    dbWriteRequest(new DBReqTelemetryWriteData(recTelemetryID, t, values, false));
+    _file.write_values(t, values, false);
+    dbWriteData(t, values, false);
 }
 void TelemetryRecorder::recordData(PBase::Values values, bool uplink)
 {
@@ -281,7 +310,9 @@ void TelemetryRecorder::recordData(PBase::Values values, bool uplink)
 
     dbCheckRecord();
 
-    dbWriteRequest(new DBReqTelemetryWriteData(recTelemetryID, getEventTimestamp(), values, uplink));
+    auto t = getEventTimestamp();
+    _file.write_values(t, values, uplink);
+    dbWriteData(t, values, uplink);
 }
 
 void TelemetryRecorder::writeEvent(const QString &name,
@@ -291,12 +322,16 @@ void TelemetryRecorder::writeEvent(const QString &name,
 {
     dbCheckRecord();
 
-    auto req = new DBReqTelemetryWriteEvent(recTelemetryID,
-                                            getEventTimestamp(),
-                                            name,
-                                            value,
-                                            uid,
-                                            uplink);
+    auto t = getEventTimestamp();
+    if (_file.isOpen()) {
+        if (name == "msg")
+            _file.write_msg(t, value, uid);
+        else
+            _file.write_evt(t, name, value, uid, uplink);
+        return;
+    }
+
+    auto req = new DBReqTelemetryWriteEvent(recTelemetryID, t, name, value, uid, uplink);
     dbWriteRequest(req);
 }
 
@@ -409,7 +444,9 @@ void TelemetryRecorder::setRecording(bool v)
 }
 void TelemetryRecorder::reset(void)
 {
+    dbFlushData();
     recTelemetryID = 0;
+    _file.close();
 
     _reset_timestamp = true;
     _ts_t0 = _ts_t1 = _ts_t2 = 0;
@@ -26,6 +26,8 @@
 #include <Vehicles/Vehicles.h>
 #include <QtCore>
 
+#include "TelemetryFile.h"
+
 class Recorder;
 class NodeItem;
 
@@ -47,6 +49,9 @@ private:
 
     quint64 recTelemetryID{};
 
+    // binary data stream
+    TelemetryFile _file;
+
     //auto recorder
     bool checkAutoRecord(void);
     Vehicle::FlightState flightState_s;
@@ -64,6 +69,10 @@ private:
     DatabaseRequest *reqNewRecord{};
     QList<DBReqTelemetryWriteBase *> reqPendingList;
 
+    // data frames coalesced for bulk insert
+    DBReqTelemetryWriteBatch *reqBatch{};
+    QTimer batchTimer;
+
     PBase::Values _values;
 
     QString confTitle;
@@ -74,8 +83,8 @@ private:
 
     void cleanupValues(PBase::Values *values);
 
-    void invalidateCache();
     void dbWriteRequest(DBReqTelemetryWriteBase *req);
+    void dbWriteData(quint64 t, const PBase::Values &values, bool uplink);
 
 private slots:
     void updateStatus();
@@ -84,6 +93,7 @@ private slots:
 
     //database
     void dbRecordCreated(quint64 telemetryID);
+    void dbFlushData();
     void writeEvent(const QString &name, const QString &value, const QString &uid, bool uplink);
 
     //internal flow
@@ -115,6 +115,13 @@ Vehicle::Vehicle(Vehicles *vehicles, PVehicle *protocol)
 
     connect(f_mode, &Fact::valueChanged, this, &Vehicle::updateFlightState);
     connect(f_stage, &Fact::valueChanged, this, &Vehicle::updateFlightState);
+    // flight state transitions must not be merged by conflated notifications
+    for (auto f : {f_mode, f_stage}) {
+        connect(static_cast<MandalaFact *>(f),
+                &MandalaFact::streamValueChanged,
+                this,
+                &Vehicle::updateFlightState);
+    }
 
     connect(this, &Fact::activeChanged, this, &Vehicle::updateActive);
     connect(f_nodes, &Nodes::upgradingChanged, this, &Vehicle::updateActive);
@@ -0,0 +1,228 @@
+/*
+ * APX Autopilot project <http://docs.uavos.com>
+ *
+ * Copyright (c) 2003-2020, Aliaksei Stratsilatau <sa@uavos.com>
+ * All rights reserved
+ *
+ * This file is part of APX Ground Control.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <Datalink/Datalink.h>
+#include <Datalink/DatalinkConnection.h>
+#include <Datalink/DatalinkEngine.h>
+#include <Mandala/Mandala.h>
+#include <Protocols/PStream.h>
+
+#include <XbusVehicle.h>
+#include <serial/CobsDecoder.h>
+#include <serial/CobsEncoder.h>
+
+#include <QtCore>
+#include <atomic>
+
+// Datalink engine throughput: synthetic PHY reads decoded by one source
+// connection and relayed to N sink connections, all handled by the engine thread.
+// Idle connections on other networks check that routing skips non-subscribers.
+
+class BenchConnection : public DatalinkConnection
+{
+public:
+    explicit BenchConnection(quint16 rxNetwork, quint16 txNetwork)
+        : DatalinkConnection(nullptr, "bench", "bench", QString(), rxNetwork, txNetwork)
+        , _dev(new QBuffer)
+    {
+        setEncoder(&_enc);
+        setDecoder(&_dec);
+        setActivated(true);
+        setActive(true);
+        _device = _dev;
+    }
+    ~BenchConnection() override
+    {
+        _device = nullptr;
+        delete _dev;
+    }
+
+    // PHY side, frames are read back by the engine thread
+    void feed(const QByteArray &data)
+    {
+        QMutexLocker lock(&_mutex);
+        _phy.append(data);
+        lock.unlock();
+        scheduleRead();
+    }
+    QIODevice *device() const { return _dev; }
+    quint64 framesCnt() const { return _framesCnt; }
+
+protected:
+    QByteArray read() override
+    {
+        QMutexLocker lock(&_mutex);
+        return _phy.isEmpty() ? QByteArray() : _phy.takeFirst();
+    }
+    void sendFrames(const Frames &frames) override
+    {
+        _framesCnt.fetch_add(static_cast<quint64>(frames.count()), std::memory_order_relaxed);
+    }
+
+private:
+    QIODevice *_dev;
+    CobsDecoder<> _dec;
+    CobsEncoder<> _enc;
+
+    QMutex _mutex;
+    QList<QByteArray> _phy;
+    std::atomic<quint64> _framesCnt{};
+};
+
+// vehicle downlink packet wrapping a telemetry payload
+static QByteArray makePacket(quint16 squawk, int size)
+{
+    uint8_t buf[xbus::size_packet_max];
+    PStreamWriter stream(buf, sizeof(buf));
+
+    xbus::pid_s pid{};
+    pid.uid = mandala::cmd::env::vehicle::downlink::uid;
+    pid.write(&stream);
+    stream.write<xbus::vehicle::squawk_t>(squawk);
+    stream.write<uint8_t>(0);
+
+    pid.uid = mandala::cmd::env::telemetry::data::uid;
+    pid.write(&stream);
+    const int space = static_cast<int>(sizeof(buf) - stream.pos());
+    stream.append(QByteArray(qMin(size, space), '\x55'));
+    return stream.toByteArray();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Datalink engine fan-out benchmark.");
+    parser.addHelpOption();
+    parser.addOption({"connections", "Sink connections count.", "N", "8"});
+    parser.addOption({"packets", "Packets to relay.", "N", "200000"});
+    parser.addOption({"idle", "Connections subscribed to other networks.", "N", "0"});
+    parser.addOption({"batch", "Frames per PHY read.", "N", "16"});
+    parser.addOption({"size", "Payload size [bytes].", "N", "64"});
+    parser.process(app);
+
+    const int nconn = qMax(1, parser.value("connections").toInt());
+    const int nidle = qMax(0, parser.value("idle").toInt());
+    const int npackets = qMax(1, parser.value("packets").toInt());
+    const int batch = qMax(1, parser.value("batch").toInt());
+    const int size = qMax(0, parser.value("size").toInt());
+
+    // PHY reads of pre-encoded frames
+    CobsEncoder<> enc;
+    QVector<QByteArray> reads;
+    quint64 bytes = 0;
+    for (int n = 0; n < npackets;) {
+        QByteArray data;
+        for (int i = 0; i < batch && n < npackets; ++i, ++n) {
+            const QByteArray packet = makePacket(static_cast<quint16>(100 + n % 4), size);
+            const auto cnt = enc.encode(packet.constData(), static_cast<size_t>(packet.size()));
+            data.append(reinterpret_cast<const char *>(enc.data()), static_cast<int>(cnt));
+        }
+        bytes += static_cast<quint64>(data.size());
+        reads.append(data);
+    }
+
+    DatalinkEngine engine;
+
+    BenchConnection src(Datalink::CLIENTS, 0);
+    QList<BenchConnection *> sinks;
+    for (int i = 0; i < nconn; ++i)
+        sinks.append(new BenchConnection(0, Datalink::CLIENTS));
+    // skipped by the subscribers table, must not cost per packet
+    QList<BenchConnection *> idle;
+    for (int i = 0; i < nidle; ++i)
+        idle.append(new BenchConnection(0, Datalink::SERVERS));
+
+    for (auto c : sinks + idle) {
+        c->setEngine(&engine);
+        engine.addConnection(c);
+        engine.attach(c, c->device());
+    }
+    src.setEngine(&engine);
+    engine.addConnection(&src);
+    engine.attach(&src, src.device());
+
+    // protocols side consumer
+    quint64 consumed = 0;
+    QObject::connect(&engine, &DatalinkEngine::packetsAvailable, &app, [&engine, &consumed]() {
+        DatalinkConnection::Packets packets;
+        while (engine.readPackets(packets))
+            consumed += static_cast<quint64>(packets.count());
+    });
+
+    QElapsedTimer t0;
+    t0.start();
+    for (auto const &data : reads)
+        src.feed(data);
+
+    const quint64 expected = static_cast<quint64>(npackets);
+    for (;;) {
+        app.processEvents(QEventLoop::AllEvents, 10);
+        bool done = true;
+        for (auto c : sinks) {
+            if (c->framesCnt() < expected) {
+                done = false;
+                break;
+            }
+        }
+        if (done && consumed + engine.overflowCnt() >= expected)
+            break;
+        if (t0.elapsed() > 60000) {
+            qWarning() << "timeout";
+            break;
+        }
+    }
+    const double dt = t0.nsecsElapsed() / 1e9;
+
+    quint64 frames = 0;
+    for (auto c : sinks)
+        frames += c->framesCnt();
+
+    QTextStream out(stdout);
+    out << QString("connections: %1, idle: %2, packets: %3, batch: %4, size: %5\n")
+               .arg(nconn)
+               .arg(nidle)
+               .arg(npackets)
+               .arg(batch)
+               .arg(size);
+    out << QString("time: %1 ms\n").arg(dt * 1000., 0, 'f', 1);
+    out << QString("rx: %1 packets/s, %2 MB/s\n")
+               .arg(npackets / dt, 0, 'f', 0)
+               .arg(bytes / dt / 1e6, 0, 'f', 2);
+    out << QString("fan-out: %1 frames/s\n").arg(frames / dt, 0, 'f', 0);
+    quint64 leaked = 0;
+    for (auto c : idle)
+        leaked += c->framesCnt();
+    if (leaked)
+        out << QString("idle connections received %1 frames\n").arg(leaked);
+    out << QString("consumed: %1, overflow: %2, latency max: %3 us\n")
+               .arg(consumed)
+               .arg(engine.overflowCnt())
+               .arg(engine.takeLatency());
+
+    for (auto c : sinks + idle)
+        engine.removeConnection(c);
+    engine.removeConnection(&src);
+    qDeleteAll(sinks);
+    qDeleteAll(idle);
+    return 0;
+}